@@ -0,0 +1,48 @@
+# Benchmarks: microbenchmarks de los núcleos y barrido de hilos
+# Se compilan siempre optimizados en su propio directorio, sin importar si
+# bin/ contiene una versión de depuración.
+
+BENCH_DIR=bench
+BENCH_OBJ_DIR=$(OBJ_DIR)/bench
+BENCH_OUT=$(BENCH_OBJ_DIR)
+BENCH_FLAGS=-O3 -DNDEBUG
+BENCH_SIZES=100000 1000000 10000000
+BENCH_REPETITIONS=5
+BENCH_THREADS=
+BENCH_SCHEDULERS=omp pool
+BENCH_INPUTS=test/input020.txt test/input021.txt
+
+BENCH_SOURCES=$(filter-out $(SRC_DIR)/main.c,$(SOURCEC))
+BENCH_OBJECTS=$(BENCH_SOURCES:$(SRC_DIR)/%.c=$(BENCH_OBJ_DIR)/src/%.o)
+BENCH_EXE=$(BENCH_OBJ_DIR)/bench
+BENCH_APP=$(BENCH_OBJ_DIR)/$(APPNAME)
+
+.PHONY: bench bench-micro bench-macro
+bench: bench-micro bench-macro
+
+bench-micro: $(BENCH_EXE)
+	mkdir -p $(BENCH_OUT)
+	$(BENCH_EXE) -r $(BENCH_REPETITIONS) -c $(BENCH_OUT)/micro.csv \
+	-j $(BENCH_OUT)/micro.json $(BENCH_SIZES)
+
+bench-macro: $(BENCH_APP)
+	mkdir -p $(BENCH_OUT)
+	bash $(BENCH_DIR)/sweep.sh $(BENCH_APP) $(BENCH_OUT)/macro.csv \
+	$(BENCH_OUT)/macro.json $(BENCH_REPETITIONS) "$(BENCH_THREADS)" \
+	"$(BENCH_SCHEDULERS)" $(BENCH_INPUTS)
+
+$(BENCH_EXE): $(BENCH_OBJ_DIR)/bench.o $(BENCH_OBJECTS)
+	$(LD) $(FLAGS) $(BENCH_FLAGS) $(INCLUDE) $^ -o $@ $(LIBS)
+
+$(BENCH_APP): $(BENCH_OBJ_DIR)/src/main.o $(BENCH_OBJECTS)
+	$(LD) $(FLAGS) $(BENCH_FLAGS) $(INCLUDE) $^ -o $@ $(LIBS)
+
+$(BENCH_OBJ_DIR)/bench.o: $(BENCH_DIR)/bench.c
+	mkdir -p $(@D)
+	$(CC) -c $(FLAGC) $(BENCH_FLAGS) $(INCLUDE) -MMD $< -o $@
+
+$(BENCH_OBJ_DIR)/src/%.o: $(SRC_DIR)/%.c
+	mkdir -p $(@D)
+	$(CC) -c $(FLAGC) $(BENCH_FLAGS) $(INCLUDE) -MMD $< -o $@
+
+-include $(BENCH_OBJ_DIR)/bench.d $(BENCH_OBJECTS:%.o=%.d)
@@ -0,0 +1,331 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "bench.h"
+
+/// Mayor cantidad de valores que convierte el microbenchmark de lectura
+#define BENCH_MAX_TOKENS (1u << 22)
+
+/**
+ * @brief Mide la generación de los primos hasta n con la criba
+ * @param context datos preparados para n
+ * @return uint64_t cantidad de primos generados
+ */
+uint64_t bench_sieve(bench_context_t* context);
+
+/**
+ * @brief Mide el conteo de las sumas fuertes del mayor par que no excede n
+ * @param context datos preparados para n
+ * @return uint64_t cantidad de sumas encontradas
+ */
+uint64_t bench_strong_sums(bench_context_t* context);
+
+/**
+ * @brief Mide el conteo de las sumas débiles del mayor impar que no excede n
+ * @param context datos preparados para n
+ * @return uint64_t cantidad de sumas encontradas
+ */
+uint64_t bench_weak_sums(bench_context_t* context);
+
+/**
+ * @brief Mide la lectura y validación de n valores, hasta BENCH_MAX_TOKENS
+ * @param context datos preparados para n
+ * @return uint64_t cantidad de valores leídos
+ */
+uint64_t bench_parse(bench_context_t* context);
+
+/**
+ * @brief Mide la impresión de las sumas fuertes listadas del mayor par que
+ *        no excede n
+ * @param context datos preparados para n
+ * @return uint64_t cantidad de sumas impresas
+ */
+uint64_t bench_print(bench_context_t* context);
+
+/**
+ * @brief Prepara los datos de los microbenchmarks para n
+ * @code
+ *   bench_context_t context;
+ *   bench_context_init(&context, 1000000);
+ * @endcode
+ * @param context estructura sin inicializar
+ * @param n tamaño del problema
+ */
+void bench_context_init(bench_context_t* context, uint64_t n);
+
+/**
+ * @brief Libera los datos preparados por bench_context_init
+ * @param context estructura inicializada
+ */
+void bench_context_destroy(bench_context_t* context);
+
+/**
+ * @brief Ejecuta repetitions veces un microbenchmark y resume los tiempos
+ * @code
+ *   bench_result_t result = bench_run(&cases[0], &context, 5);
+ * @endcode
+ * @param bench_case microbenchmark a medir
+ * @param context datos preparados para n
+ * @param repetitions cantidad de repeticiones, al menos una
+ * @return bench_result_t mejor tiempo y tiempo promedio en segundos
+ */
+bench_result_t bench_run(const bench_case_t* bench_case,
+                         bench_context_t* context, uint32_t repetitions);
+
+/**
+ * @brief Escribe los resultados como CSV con una fila por microbenchmark
+ * @param file archivo de salida
+ * @param results resultados a escribir
+ * @param count cantidad de resultados
+ */
+void bench_write_csv(FILE* file, const bench_result_t* results,
+                     uint32_t count);
+
+/**
+ * @brief Escribe los resultados como un arreglo JSON de objetos
+ * @param file archivo de salida
+ * @param results resultados a escribir
+ * @param count cantidad de resultados
+ */
+void bench_write_json(FILE* file, const bench_result_t* results,
+                      uint32_t count);
+
+/**
+ * @brief Retorna los segundos transcurridos desde start
+ * @param start tiempo inicial de CLOCK_MONOTONIC
+ * @return double segundos transcurridos
+ */
+double bench_elapsed(const struct timespec* start);
+
+/// Microbenchmarks en el orden en que se ejecutan para cada n
+static const bench_case_t bench_cases[] = {
+  {"sieve", bench_sieve},
+  {"strong_sums", bench_strong_sums},
+  {"weak_sums", bench_weak_sums},
+  {"parse", bench_parse},
+  {"print", bench_print},
+};
+
+int main(int argc, char* argv[]) {
+  uint32_t repetitions = BENCH_REPETITIONS;
+  const char* csv_path = NULL;
+  const char* json_path = NULL;
+  uint64_t sizes[BENCH_MAX_SIZES];
+  uint32_t size_count = 0;
+  // Leer las opciones y los valores de n
+  for (int index = 1; index < argc; ++index) {
+    if (strcmp(argv[index], "-r") == 0 && index + 1 < argc) {
+      repetitions = (uint32_t) strtoul(argv[++index], NULL, 10);
+    } else if (strcmp(argv[index], "-c") == 0 && index + 1 < argc) {
+      csv_path = argv[++index];
+    } else if (strcmp(argv[index], "-j") == 0 && index + 1 < argc) {
+      json_path = argv[++index];
+    } else if (size_count < BENCH_MAX_SIZES) {
+      sizes[size_count++] = strtoull(argv[index], NULL, 10);
+    }
+  }
+  if (repetitions == 0)
+    repetitions = 1;
+  if (size_count == 0) {
+    sizes[size_count++] = 100000;
+    sizes[size_count++] = 1000000;
+    sizes[size_count++] = 10000000;
+  }
+  uint32_t case_count = sizeof(bench_cases) / sizeof(bench_cases[0]);
+  bench_result_t* results = (bench_result_t*)
+      calloc(size_count * case_count, sizeof(bench_result_t));
+  uint32_t result_count = 0;
+  // Medir cada microbenchmark para cada n, preparando los datos una vez
+  for (uint32_t size = 0; size < size_count; ++size) {
+    if (sizes[size] < 6 || sizes[size] > GOLDBACH_MAX_VALUE) {
+      fprintf(stderr, "Error: n must be between 6 and %" PRIu64 "\n",
+              (uint64_t) GOLDBACH_MAX_VALUE);
+      continue;
+    }
+    bench_context_t context;
+    bench_context_init(&context, sizes[size]);
+    for (uint32_t index = 0; index < case_count; ++index) {
+      results[result_count] = bench_run(&bench_cases[index], &context,
+                                         repetitions);
+      fprintf(stderr, "%-12s n=%-12" PRIu64 " %.6fs\n",
+              results[result_count].name, results[result_count].n,
+              results[result_count].best_time);
+      ++result_count;
+    }
+    bench_context_destroy(&context);
+  }
+  // Escribir los resultados en los archivos indicados, o el CSV en stdout
+  FILE* csv_file = csv_path ? fopen(csv_path, "w") : stdout;
+  if (csv_file) {
+    bench_write_csv(csv_file, results, result_count);
+    if (csv_file != stdout)
+      fclose(csv_file);
+  } else {
+    fprintf(stderr, "Error: could not write %s\n", csv_path);
+  }
+  if (json_path) {
+    FILE* json_file = fopen(json_path, "w");
+    if (json_file) {
+      bench_write_json(json_file, results, result_count);
+      fclose(json_file);
+    } else {
+      fprintf(stderr, "Error: could not write %s\n", json_path);
+    }
+  }
+  free(results);
+  return EXIT_SUCCESS;
+}
+
+void bench_context_init(bench_context_t* context, uint64_t n) {
+  assert(context);
+  context -> n = n;
+  // La criba de las sumas se construye fuera de su medición
+  context -> sieve = sieve_create(n < SIEVE_MAX_LIMIT ? (uint32_t) n
+                                                      : SIEVE_MAX_LIMIT);
+  /* Archivo temporal con n valores de ambos signos para medir la lectura,
+     pues reader_t lee directamente del descriptor */
+  uint64_t token_count = n < BENCH_MAX_TOKENS ? n : BENCH_MAX_TOKENS;
+  context -> input = tmpfile();
+  for (uint64_t token = 0; context -> input && token < token_count;
+       ++token) {
+    fprintf(context -> input, "%s%" PRIu64 "\n", token % 4 == 0 ? "-" : "",
+            (token * 2654435761u) % n);
+  }
+  if (context -> input)
+    fflush(context -> input);
+  // Entrada negativa par cuyas sumas se imprimen, con su cantidad calculada
+  char entry[24];
+  int length = snprintf(entry, sizeof(entry), "-%" PRIu64,
+                        (uint64_t) (n & ~1ull));
+  context -> listed = goldbach_create(entry, (uint32_t) length, NULL);
+  goldbach_run(context -> listed, context -> sieve, NULL);
+  context -> sink = fopen("/dev/null", "w");
+}
+
+void bench_context_destroy(bench_context_t* context) {
+  assert(context);
+  sieve_destroy(context -> sieve);
+  if (context -> input)
+    fclose(context -> input);
+  goldbach_destroy(context -> listed);
+  if (context -> sink)
+    fclose(context -> sink);
+}
+
+bench_result_t bench_run(const bench_case_t* bench_case,
+                         bench_context_t* context, uint32_t repetitions) {
+  bench_result_t result = {bench_case -> name, context -> n, repetitions,
+                           0.0, 0.0, 0};
+  double total_time = 0.0;
+  // Conservar el mejor tiempo, el menos afectado por otros procesos
+  for (uint32_t repetition = 0; repetition < repetitions; ++repetition) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    result.items = bench_case -> function(context);
+    double elapsed = bench_elapsed(&start);
+    total_time += elapsed;
+    if (repetition == 0 || elapsed < result.best_time)
+      result.best_time = elapsed;
+  }
+  result.mean_time = total_time / repetitions;
+  return result;
+}
+
+uint64_t bench_sieve(bench_context_t* context) {
+  uint32_t limit = sieve_get_limit(context -> sieve);
+  sieve_t* sieve = sieve_create(limit);
+  uint64_t count = sieve_count_primes(sieve, limit);
+  sieve_destroy(sieve);
+  return count;
+}
+
+uint64_t bench_strong_sums(bench_context_t* context) {
+  char entry[24];
+  int length = snprintf(entry, sizeof(entry), "%" PRIu64,
+                        (uint64_t) (context -> n & ~1ull));
+  goldbach_t* goldbach = goldbach_create(entry, (uint32_t) length, NULL);
+  goldbach_run(goldbach, context -> sieve, NULL);
+  uint64_t count = goldbach_get_count(goldbach);
+  goldbach_destroy(goldbach);
+  return count;
+}
+
+uint64_t bench_weak_sums(bench_context_t* context) {
+  char entry[24];
+  uint64_t value = context -> n % 2 == 1 ? context -> n : context -> n - 1;
+  int length = snprintf(entry, sizeof(entry), "%" PRIu64, value);
+  goldbach_t* goldbach = goldbach_create(entry, (uint32_t) length, NULL);
+  goldbach_run(goldbach, context -> sieve, NULL);
+  uint64_t count = goldbach_get_count(goldbach);
+  goldbach_destroy(goldbach);
+  return count;
+}
+
+uint64_t bench_parse(bench_context_t* context) {
+  if (!context -> input)
+    return 0;
+  reader_t reader;
+  arena_t arena;
+  const char* token = NULL;
+  uint32_t length = 0;
+  uint64_t count = 0;
+  // Leer y validar cada valor como lo hace el solver en modo por lotes
+  lseek(fileno(context -> input), 0, SEEK_SET);
+  reader_init(&reader, context -> input);
+  arena_init(&arena);
+  while (reader_next(&reader, &token, &length)) {
+    goldbach_create(token, length, &arena);
+    ++count;
+  }
+  arena_destroy(&arena);
+  reader_destroy(&reader);
+  return count;
+}
+
+uint64_t bench_print(bench_context_t* context) {
+  writer_t writer;
+  writer_init(&writer, context -> sink);
+  goldbach_print(context -> listed, context -> sieve, &writer);
+  writer_destroy(&writer);
+  return goldbach_get_count(context -> listed);
+}
+
+void bench_write_csv(FILE* file, const bench_result_t* results,
+                     uint32_t count) {
+  fprintf(file, "benchmark,n,repetitions,best_seconds,mean_seconds,items,"
+          "items_per_second\n");
+  for (uint32_t index = 0; index < count; ++index) {
+    const bench_result_t* result = &results[index];
+    fprintf(file, "%s,%" PRIu64 ",%u,%.9f,%.9f,%" PRIu64 ",%.1f\n",
+            result -> name, result -> n, result -> repetitions,
+            result -> best_time, result -> mean_time, result -> items,
+            result -> best_time > 0 ? result -> items / result -> best_time
+                                    : 0.0);
+  }
+}
+
+void bench_write_json(FILE* file, const bench_result_t* results,
+                      uint32_t count) {
+  fprintf(file, "[\n");
+  for (uint32_t index = 0; index < count; ++index) {
+    const bench_result_t* result = &results[index];
+    fprintf(file, "  {\"benchmark\": \"%s\", \"n\": %" PRIu64 ", "
+            "\"repetitions\": %u, \"best_seconds\": %.9f, "
+            "\"mean_seconds\": %.9f, \"items\": %" PRIu64 ", "
+            "\"items_per_second\": %.1f}%s\n",
+            result -> name, result -> n, result -> repetitions,
+            result -> best_time, result -> mean_time, result -> items,
+            result -> best_time > 0 ? result -> items / result -> best_time
+                                    : 0.0,
+            index + 1 < count ? "," : "");
+  }
+  fprintf(file, "]\n");
+}
+
+double bench_elapsed(const struct timespec* start) {
+  struct timespec finish;
+  clock_gettime(CLOCK_MONOTONIC, &finish);
+  return finish.tv_sec - start -> tv_sec +
+         (finish.tv_nsec - start -> tv_nsec) / 1000000000.0;
+}
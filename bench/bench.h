@@ -0,0 +1,69 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef BENCH_H
+#define BENCH_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include "arena.h"
+#include "goldbach.h"
+#include "reader.h"
+#include "sieve.h"
+#include "writer.h"
+
+/// Repeticiones de cada microbenchmark si no se indican con -r
+#define BENCH_REPETITIONS 5
+/// Cantidad máxima de valores de n por corrida
+#define BENCH_MAX_SIZES 32
+
+/**
+ * @brief Datos que se preparan una vez por cada n, fuera de la medición
+ * @details Cada microbenchmark mide solo su núcleo, por lo que la criba de
+ *          las sumas, el archivo de valores a leer y la entrada a imprimir
+ *          se construyen antes de empezar a medir
+ */
+typedef struct bench_context {
+  uint64_t n;
+  sieve_t* sieve;
+  FILE* input;
+  goldbach_t* listed;
+  FILE* sink;
+} bench_context_t;
+
+/**
+ * @brief Función que ejecuta una vez un microbenchmark
+ * @param context datos preparados para n
+ * @return uint64_t cantidad de elementos procesados, para calcular el
+ *         rendimiento
+ */
+typedef uint64_t (*bench_function_t)(bench_context_t* context);
+
+/**
+ * @brief Microbenchmark con el nombre que aparece en los resultados
+ */
+typedef struct bench_case {
+  const char* name;
+  bench_function_t function;
+} bench_case_t;
+
+/**
+ * @brief Resultado de repetir un microbenchmark para un valor de n
+ */
+typedef struct bench_result {
+  const char* name;
+  uint64_t n;
+  uint32_t repetitions;
+  double best_time;
+  double mean_time;
+  uint64_t items;
+} bench_result_t;
+
+#endif  // !BENCH_H
@@ -0,0 +1,86 @@
+#!/bin/bash
+# Barrido de hilos sobre archivos de prueba, con velocidad y eficiencia
+# calculadas como en report/README.md: la velocidad es el tiempo con un
+# hilo entre el tiempo con t hilos y la eficiencia es la velocidad entre t.
+#
+# Uso: bench/sweep.sh EJECUTABLE CSV JSON REPETICIONES "HILOS"
+#        "PLANIFICADORES" ARCHIVO...
+# Si HILOS es vacío se usan 1, la mitad de las CPU, las CPU, el doble y el
+# cuádruple, las mismas columnas de la Comparación #2 del reporte. Los
+# planificadores son omp (el ciclo de OpenMP), pool (robo de trabajo con
+# --pool) y pin (robo de trabajo con hilos fijos, --pin); si es vacío solo
+# se mide omp. La velocidad de cada uno es respecto a su propio tiempo con
+# un hilo.
+
+set -e
+
+executable=$1
+csv_path=$2
+json_path=$3
+repetitions=$4
+threads=$5
+schedulers=${6:-omp}
+shift 6
+
+cpus=$(nproc)
+if [ -z "$threads" ]; then
+  threads=$(printf "%s\n" 1 $((cpus / 2)) "$cpus" $((2 * cpus)) \
+    $((4 * cpus)) | awk '$1 > 0 && !seen[$1]++')
+fi
+
+# Retorna el menor tiempo de REPETICIONES corridas con HILOS, ARCHIVO y
+# PLANIFICADOR, tomado de la línea "Elapsed time" que el programa escribe en
+# stderr; la salida estándar se descarta
+best_time() {
+  local best=""
+  local arguments=()
+  case "$3" in
+    pool) arguments=(--pool) ;;
+    pin) arguments=(--pin) ;;
+  esac
+  for ((repetition = 0; repetition < repetitions; ++repetition)); do
+    local time
+    time=$("$executable" "$1" "${arguments[@]}" < "$2" 2>&1 >/dev/null \
+      | awk '/^Elapsed time:/ { sub(/s$/, "", $3); print $3 }')
+    if [ -z "$best" ] || awk -v a="$time" -v b="$best" \
+        'BEGIN { exit !(a < b) }'; then
+      best=$time
+    fi
+  done
+  echo "$best"
+}
+
+echo "input,scheduler,threads,repetitions,best_seconds,speedup,efficiency" \
+  > "$csv_path"
+for input in "$@"; do
+  for scheduler in $schedulers; do
+    serial_time=$(best_time 1 "$input" "$scheduler")
+    for thread_count in $threads; do
+      if [ "$thread_count" -eq 1 ]; then
+        time=$serial_time
+      else
+        time=$(best_time "$thread_count" "$input" "$scheduler")
+      fi
+      awk -v input="$input" -v scheduler="$scheduler" \
+        -v threads="$thread_count" -v r="$repetitions" -v time="$time" \
+        -v serial="$serial_time" 'BEGIN {
+          speedup = time > 0 ? serial / time : 0
+          printf "%s,%s,%d,%d,%.9f,%.2f,%.2f\n", input, scheduler, threads,
+            r, time, speedup, speedup / threads }' >> "$csv_path"
+      echo "$input $scheduler threads=$thread_count ${time}s" >&2
+    done
+  done
+done
+
+# Convertir el CSV en un arreglo JSON de objetos
+awk -F, 'NR > 1 {
+    rows[++count] = sprintf("  {\"input\": \"%s\", \"scheduler\": \"%s\", " \
+      "\"threads\": %s, \"repetitions\": %s, \"best_seconds\": %s, " \
+      "\"speedup\": %s, \"efficiency\": %s}", $1, $2, $3, $4, $5, $6, $7)
+  }
+  END {
+    print "["
+    for (row = 1; row <= count; ++row)
+      print rows[row] (row < count ? "," : "")
+    print "]"
+  }' "$csv_path" > "$json_path"
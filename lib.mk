@@ -0,0 +1,56 @@
+# Biblioteca libgoldbach: el cálculo sin la entrada ni la salida estándar
+# Se compila optimizada y con código independiente de la posición en su
+# propio directorio, con todos los módulos salvo main.c. La interfaz pública
+# es src/engine.h: los símbolos se ocultan por omisión y solo se exportan las
+# funciones marcadas con ENGINE_API. La biblioteca estática enlaza antes todos
+# los módulos en un solo objeto y vuelve locales los símbolos ocultos, para
+# que las funciones auxiliares no choquen con las del programa que la usa.
+# test-lib enlaza test/engine_test.c con cada versión y lo ejecuta.
+
+LIB_NAME=goldbach
+LIB_OBJ_DIR=$(OBJ_DIR)/lib
+LIB_FLAGS=-O3 -DNDEBUG -fPIC -fvisibility=hidden
+LIB_SOURCES=$(filter-out $(SRC_DIR)/main.c,$(SOURCEC))
+LIB_OBJECTS=$(LIB_SOURCES:$(SRC_DIR)/%.c=$(LIB_OBJ_DIR)/%.o)
+LIB_STATIC=$(BIN_DIR)/lib$(LIB_NAME).a
+LIB_MERGED=$(LIB_OBJ_DIR)/lib$(LIB_NAME).o
+LIB_SHARED=$(BIN_DIR)/lib$(LIB_NAME).so
+LIB_TEST_SOURCE=test/engine_test.c
+LIB_TEST_STATIC=$(LIB_OBJ_DIR)/engine_test_static
+LIB_TEST_SHARED=$(LIB_OBJ_DIR)/engine_test_shared
+
+.PHONY: lib
+lib: $(LIB_STATIC) $(LIB_SHARED)
+
+test: test-lib
+
+.PHONY: test-lib
+test-lib: $(LIB_TEST_STATIC) $(LIB_TEST_SHARED)
+	$(LIB_TEST_STATIC)
+	LD_LIBRARY_PATH=$(BIN_DIR) $(LIB_TEST_SHARED)
+
+# Solo con engine.h, como cualquier programa que usa la biblioteca
+$(LIB_TEST_STATIC): $(LIB_TEST_SOURCE) $(LIB_STATIC)
+	$(CC) $(FLAGC) -I$(SRC_DIR) $^ -o $@ $(LIBS)
+
+$(LIB_TEST_SHARED): $(LIB_TEST_SOURCE) $(LIB_SHARED)
+	$(CC) $(FLAGC) -I$(SRC_DIR) $< -L$(BIN_DIR) -l$(LIB_NAME) -o $@ $(LIBS)
+
+$(LIB_STATIC): $(LIB_MERGED)
+	mkdir -p $(@D)
+	rm -f $@
+	$(AR) rcs $@ $^
+
+$(LIB_MERGED): $(LIB_OBJECTS)
+	$(LD) -r -nostdlib $^ -o $@
+	objcopy --localize-hidden $@
+
+$(LIB_SHARED): $(LIB_OBJECTS)
+	mkdir -p $(@D)
+	$(LD) -shared $(FLAGS) $(LIB_FLAGS) $^ -o $@ $(LIBS)
+
+$(LIB_OBJ_DIR)/%.o: $(SRC_DIR)/%.c
+	mkdir -p $(@D)
+	$(CC) -c $(FLAGC) $(LIB_FLAGS) $(INCLUDE) -MMD $< -o $@
+
+-include $(LIB_OBJECTS:%.o=%.d)
@@ -0,0 +1,37 @@
+# Pruebas con MPI: los casos de prueba repartidos entre varios procesos
+# El ejecutable se compila con mpicc en su propio directorio, sin importar si
+# bin/ contiene una versión sin MPI, y cada caso de test/ que tiene salida
+# esperada se ejecuta con cada cantidad de procesos y se compara con ella.
+
+MPI_CC=mpicc
+MPI_RUN=mpirun --oversubscribe
+MPI_PROCESSES=2 4
+MPI_TEST_DIR=test
+MPI_DIFF=icdiff --no-headers
+MPI_OBJ_DIR=$(OBJ_DIR)/mpi
+MPI_FLAGS=-O3 -DNDEBUG -DGOLDBACH_MPI
+MPI_OBJECTS=$(SOURCEC:$(SRC_DIR)/%.c=$(MPI_OBJ_DIR)/%.o)
+MPI_EXE=$(MPI_OBJ_DIR)/$(APPNAME)
+MPI_TESTOUT=$(wildcard $(MPI_TEST_DIR)/*output*.txt)
+
+.PHONY: test-mpi
+test-mpi: SHELL:=/bin/bash
+test-mpi: $(MPI_EXE)
+	@for processes in $(MPI_PROCESSES); do \
+	  for output in $(MPI_TESTOUT); do \
+	    input=$${output/output/input}; \
+	    echo "$(MPI_RUN) -np $$processes $(MPI_EXE) $(ARGS) < $$input"; \
+	    $(MPI_DIFF) $$output \
+	    <($(MPI_RUN) -np $$processes $(MPI_EXE) $(ARGS) < $$input) || exit 1; \
+	  done; \
+	done
+
+$(MPI_EXE): $(MPI_OBJECTS)
+	mkdir -p $(@D)
+	$(MPI_CC) $(FLAGS) $(MPI_FLAGS) $^ -o $@ $(LIBS)
+
+$(MPI_OBJ_DIR)/%.o: $(SRC_DIR)/%.c
+	mkdir -p $(@D)
+	$(MPI_CC) -c $(FLAGC) $(MPI_FLAGS) $(INCLUDE) -MMD $< -o $@
+
+-include $(MPI_OBJECTS:%.o=%.d)
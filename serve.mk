@@ -0,0 +1,51 @@
+# Pruebas del servidor: consultas por el socket de dominio Unix
+# Inicia el programa con --serve y conecta a la vez varios clientes por cada
+# caso de test/, que envían su entrada y reciben la respuesta. Cada respuesta
+# debe ser igual a la salida del mismo programa en modo de lote. Al final
+# detiene el servidor con SIGINT y comprueba que eliminó el socket. Los
+# procesos se limitan a SERVE_TIMEOUT segundos para que un bloqueo falle.
+
+SERVE_DIR=$(OBJ_DIR)/serve
+SERVE_CLIENT=$(SERVE_DIR)/serve_client
+SERVE_SOCKET=$(SERVE_DIR)/goldbach.sock
+SERVE_CLIENTS=4
+SERVE_TIMEOUT=600
+SERVE_TEST_DIR=test
+SERVE_INPUTS=$(wildcard $(SERVE_TEST_DIR)/*input*.txt)
+
+test: test-serve
+
+.PHONY: test-serve
+test-serve: SHELL:=/bin/bash
+test-serve: $(EXEFILE) $(SERVE_CLIENT)
+	@rm -f $(SERVE_SOCKET) $(SERVE_DIR)/*.out
+	@timeout $(SERVE_TIMEOUT) $(EXEARGS) --serve $(SERVE_SOCKET) & server=$$!; \
+	for try in $$(seq 100); do \
+	  [ -S $(SERVE_SOCKET) ] && break; sleep 0.05; \
+	done; \
+	clients=; \
+	for input in $(SERVE_INPUTS); do \
+	  name=$$(basename $$input .txt); \
+	  for client in $$(seq $(SERVE_CLIENTS)); do \
+	    timeout $(SERVE_TIMEOUT) $(SERVE_CLIENT) $(SERVE_SOCKET) < $$input \
+	      > $(SERVE_DIR)/$$name.$$client.out & clients="$$clients $$!"; \
+	  done; \
+	done; \
+	error=0; \
+	for client in $$clients; do wait $$client || error=1; done; \
+	for input in $(SERVE_INPUTS); do \
+	  name=$$(basename $$input .txt); \
+	  echo "$(SERVE_CLIENT) $(SERVE_SOCKET) < $$input ($(SERVE_CLIENTS))"; \
+	  expected=$$($(EXEARGS) < $$input 2>/dev/null | md5sum); \
+	  for client in $$(seq $(SERVE_CLIENTS)); do \
+	    [ "$$(md5sum < $(SERVE_DIR)/$$name.$$client.out)" = "$$expected" ] \
+	      || { echo "error: $$name.$$client.out"; error=1; }; \
+	  done; \
+	done; \
+	kill -INT $$server; wait $$server || error=1; \
+	[ ! -e $(SERVE_SOCKET) ] || { echo "error: socket not removed"; error=1; }; \
+	exit $$error
+
+$(SERVE_CLIENT): $(SERVE_TEST_DIR)/serve_client.c
+	mkdir -p $(@D)
+	$(CC) $(FLAGC) $< -o $@
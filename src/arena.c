@@ -0,0 +1,51 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "arena.h"
+
+/// Encabezado de cada bloque, los bytes reservables inician después de él
+struct arena_block {
+  arena_block_t* previous;
+};
+
+void arena_init(arena_t* arena) {
+  assert(arena);
+  // Inicializar campos de la estructura
+  arena -> position = NULL;
+  arena -> end = NULL;
+  arena -> blocks = NULL;
+}
+
+void arena_destroy(arena_t* arena) {
+  assert(arena);
+  // Liberar todos los bloques de una vez
+  while (arena -> blocks) {
+    arena_block_t* previous = arena -> blocks -> previous;
+    free(arena -> blocks);
+    arena -> blocks = previous;
+  }
+  arena -> position = NULL;
+  arena -> end = NULL;
+}
+
+void* arena_allocate(arena_t* arena, size_t size) {
+  assert(arena);
+  size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+  // Pedir un bloque nuevo en cero si la reserva no cabe en el actual
+  if ((size_t) (arena -> end - arena -> position) < size) {
+    size_t capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+    arena_block_t* block = (arena_block_t*) calloc(1, sizeof(arena_block_t)
+                                                   + capacity);
+    if (!block)
+      return NULL;
+    block -> previous = arena -> blocks;
+    arena -> blocks = block;
+    arena -> position = (char*) (block + 1);
+    arena -> end = arena -> position + capacity;
+  }
+  // Avanzar la posición del bloque actual
+  void* address = arena -> position;
+  arena -> position += size;
+  return address;
+}
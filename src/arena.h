@@ -0,0 +1,74 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef ARENA_H
+#define ARENA_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+/// Bytes de cada bloque que el arena pide al sistema
+#define ARENA_BLOCK_SIZE (1u << 20)
+
+/// Alineamiento de cada reserva, suficiente para enteros de 64 bits y
+/// punteros
+#define ARENA_ALIGNMENT 8
+
+/// Bloque de memoria del arena, enlazado con el bloque anterior
+typedef struct arena_block arena_block_t;
+
+/**
+ * @brief Estructura de datos que reserva memoria para muchos objetos
+ *        pequeños que se liberan a la vez
+ * @details Cada reserva avanza position dentro del bloque actual, sin
+ *          encabezado por objeto ni llamadas a malloc, y cuando el bloque se
+ *          agota se pide uno nuevo de ARENA_BLOCK_SIZE bytes. Los objetos no
+ *          se liberan individualmente, sino todos los bloques juntos con
+ *          arena_destroy. No es seguro para varios hilos, cada arena debe
+ *          usarse desde un solo hilo o con un mutex.
+ */
+typedef struct arena {
+  char* position;
+  char* end;
+  arena_block_t* blocks;
+} arena_t;
+
+/**
+ * @brief Inicializador, inicializa un arena vacío
+ * @code
+ *   arena_init(&arena);
+ * @endcode
+ * @param arena arena sin inicializar
+ */
+void arena_init(arena_t* arena);
+
+/**
+ * @brief Destructor, libera todos los bloques del arena
+ * @details Invalida todas las reservas hechas con el arena
+ * @code
+ *   arena_destroy(&arena);
+ * @endcode
+ * @param arena arena inicializado
+ */
+void arena_destroy(arena_t* arena);
+
+/**
+ * @brief Reserva size bytes inicializados en cero
+ * @details Las reservas mayores que ARENA_BLOCK_SIZE reciben un bloque de su
+ *          tamaño
+ * @code
+ *   goldbach_t* goldbach = (goldbach_t*) arena_allocate(&arena,
+ *                                                       sizeof(goldbach_t));
+ * @endcode
+ * @param arena arena inicializado
+ * @param size cantidad de bytes
+ * @return void* dirección alineada a ARENA_ALIGNMENT, o NULL si no hay
+ *         memoria
+ */
+void* arena_allocate(arena_t* arena, size_t size);
+
+#endif  // !ARENA_H
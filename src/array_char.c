@@ -15,20 +15,37 @@
  */
 void more_capacity(array_char_t* array);
 
-void array_char_init(array_char_t* array) {
+/**
+ * @brief Cambia la capacidad del arreglo a capacity elementos
+ * @details Con un arena reserva un arreglo nuevo en él y copia los
+ *          elementos, pues el arena no libera el anterior; si no usa realloc
+ * @code
+ *   bool is_reserved = reserve_capacity(array, 16);
+ * @endcode
+ * @param array arreglo
+ * @param capacity nueva capacidad, mayor que count
+ * @return
+ *   true: si se pudo reservar la memoria
+ *   false: si no hay memoria, en cuyo caso el arreglo no cambia
+ */
+bool reserve_capacity(array_char_t* array, uint32_t capacity);
+
+void array_char_init(array_char_t* array, arena_t* arena) {
   assert(array);
   // Inicializar campos de la estructura
   array -> count = 0;
   array -> capacity = 0;
   array -> elements = NULL;
+  array -> arena = arena;
 }
 
 void array_char_destroy(array_char_t* array) {
   assert(array);
-  // Liberar la memoria utilizada por la estructura
+  // Liberar la memoria utilizada por la estructura, salvo si es del arena
   array -> capacity = 0;
   array -> count = 0;
-  free(array -> elements);
+  if (!array -> arena)
+    free(array -> elements);
 }
 
 void array_char_add(array_char_t* array, char element) {
@@ -40,17 +57,40 @@ void array_char_add(array_char_t* array, char element) {
   array -> elements[array -> count++] = element;
 }
 
+void array_char_add_elements(array_char_t* array, const char* elements,
+                             uint32_t count) {
+  assert(array);
+  // Reservar de una vez la capacidad faltante y copiar los elementos
+  if (array -> count + count > array -> capacity &&
+      !reserve_capacity(array, array -> count + count))
+    return;
+  memcpy(array -> elements + array -> count, elements, count);
+  array -> count += count;
+}
+
 void more_capacity(array_char_t* array) {
   assert(array);
-  // Aumentar capacidad de la estructura
-  uint32_t new_capacity = 10 * (array -> capacity ? array -> capacity : 1);
+  // Aumentar la capacidad de la estructura en 1.5 veces
+  uint32_t new_capacity = array -> capacity < 8 ? 8 : array -> capacity
+                                                      + array -> capacity / 2;
+  reserve_capacity(array, new_capacity);
+}
+
+bool reserve_capacity(array_char_t* array, uint32_t capacity) {
+  char* new_elements = NULL;
   // Copiar los elementos del antiguo arreglo en el nuevo
-  char* new_elements = (char*) realloc(array -> elements,
-                                               new_capacity * sizeof(char));
-  if (new_elements) {
-    array -> capacity = new_capacity;
-    array -> elements = new_elements;
+  if (array -> arena) {
+    new_elements = (char*) arena_allocate(array -> arena, capacity);
+    if (new_elements && array -> count)
+      memcpy(new_elements, array -> elements, array -> count);
+  } else {
+    new_elements = (char*) realloc(array -> elements, capacity);
   }
+  if (!new_elements)
+    return false;
+  array -> capacity = capacity;
+  array -> elements = new_elements;
+  return true;
 }
 
 char* array_char_get_elements(array_char_t* array) {
@@ -8,27 +8,35 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
+#include <stdbool.h>
+#include "arena.h"
 
 /**
  * @brief Estructura de datos que se encarga de almacenar elementos de tipo
  *        char, de forma efectiva y evita buffers overflows y erores de
  *        memoria
+ * @details Si arena no es NULL los elementos se reservan en él y se liberan
+ *          junto con el arena, si no se reservan con realloc
  */
 typedef struct array_char {
   uint32_t count;
   uint32_t capacity;
   char* elements;
+  arena_t* arena;
 } array_char_t;
 
 /**
  * @brief Inicializador, inicializa los campos de la estructura de datos
  * @code 
- *   array_char_init(&array);
+ *   array_char_init(&array, NULL);
  * @endcode
  * @param array arreglo sin inicializar
+ * @param arena arena donde se reservan los elementos, o NULL para usar el
+ *        heap
  */
-void array_char_init(array_char_t* array);
+void array_char_init(array_char_t* array, arena_t* arena);
 
 /**
  * @brief Destructor, destruye la estructura y libera la memoria empleada
@@ -49,6 +57,20 @@ void array_char_destroy(array_char_t* array);
  */
 void array_char_add(array_char_t* array, char element);
 
+/**
+ * @brief Agrega count elementos al final del arreglo
+ * @details Reserva la capacidad faltante una sola vez en lugar de crecer
+ *          por cada caracter
+ * @code
+ *   array_char_add_elements(&array, "-21", 3);
+ * @endcode
+ * @param array arreglo en el cual se van a agregar los elementos
+ * @param elements elementos a agregar al arreglo
+ * @param count cantidad de elementos
+ */
+void array_char_add_elements(array_char_t* array, const char* elements,
+                             uint32_t count);
+
 /**
  * @brief Retorna el campo elements de la estructura
  *   char* array_elements = array_char_get_elements(&array);
@@ -44,8 +44,9 @@ void array_goldbach_add(array_goldbach_t* array, goldbach_t* element) {
 
 void add_capacity(array_goldbach_t* array) {
   assert(array);
-  // Aumentar capacidad de la estructura
-  uint32_t new_capacity = 10 * (array -> capacity ? array -> capacity : 1);
+  // Aumentar la capacidad de la estructura en 1.5 veces
+  uint32_t new_capacity = array -> capacity < 8 ? 8 : array -> capacity
+                                                      + array -> capacity / 2;
   // Copiar los elementos del antiguo arreglo en el nuevo
   goldbach_t** new_elements = (goldbach_t**) realloc(array -> elements,
                               new_capacity * sizeof(goldbach_t*));
@@ -0,0 +1,247 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "convolution.h"
+
+/// Máxima cantidad de mariposas consecutivas que procesa un hilo a la vez
+#define CONVOLUTION_CHUNK 4096
+
+/// Versiones de los ciclos de mariposas para cada conjunto de instrucciones.
+/// ThreadSanitizer instrumenta el selector que genera el compilador, el cual
+/// corre antes de inicializarse, por lo que con él se usa una sola versión.
+#ifdef __SANITIZE_THREAD__
+#define CONVOLUTION_CLONES
+#else
+#define CONVOLUTION_CLONES \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+
+/**
+ * @brief Calcula base elevado a exponent módulo modulus
+ * @code
+ *   uint32_t value = power_mod(3, 4, 7);
+ *   //Retorna: 4
+ * @endcode
+ * @param base base de la potencia
+ * @param exponent exponente de la potencia
+ * @param modulus módulo
+ * @return uint32_t resultado de la potencia
+ */
+uint32_t power_mod(uint64_t base, uint64_t exponent, uint32_t modulus);
+
+/**
+ * @brief Retorna -modulus^-1 módulo 2^32, necesario para la reducción de
+ *        Montgomery
+ * @code
+ *   uint32_t inverse = negated_inverse(CONVOLUTION_MODULUS);
+ * @endcode
+ * @param modulus número impar
+ * @return uint32_t inverso negado de modulus
+ */
+uint32_t negated_inverse(uint32_t modulus);
+
+/**
+ * @brief Multiplica dos números con la reducción de Montgomery
+ * @details Retorna left * right * 2^-32 módulo modulus, de forma que si
+ *          right está en forma de Montgomery (right * 2^32 mod modulus) el
+ *          resultado es el producto en la misma forma que left, sin la
+ *          división de 64 bits
+ * @code
+ *   uint32_t product = montgomery_multiply(left, right, modulus, inverse);
+ * @endcode
+ * @param left primer factor, menor que modulus
+ * @param right segundo factor, menor que modulus
+ * @param modulus número primo impar menor que 2^31
+ * @param inverse -modulus^-1 módulo 2^32
+ * @return uint32_t producto reducido, menor que modulus
+ */
+static inline uint32_t montgomery_multiply(uint32_t left, uint32_t right,
+                                           uint32_t modulus, uint32_t inverse) {
+  uint64_t product = (uint64_t) left * right;
+  uint32_t factor = (uint32_t) product * inverse;
+  uint32_t result = (product + (uint64_t) factor * modulus) >> 32;
+  return result >= modulus ? result - modulus : result;
+}
+
+/**
+ * @brief Combina dos mitades de un bloque de la transformada
+ * @details Aplica half mariposas entre los arreglos even y odd usando las
+ *          raíces de la unidad en forma de Montgomery, así el producto se
+ *          reduce sin la división de 64 bits. El compilador genera versiones
+ *          vectorizadas para AVX-512 y AVX2 y la adecuada se elige al cargar
+ *          el programa según el procesador.
+ * @code
+ *   combine_butterflies(even, odd, roots, half, modulus, inverse);
+ * @endcode
+ * @param even primera mitad del bloque
+ * @param odd segunda mitad del bloque
+ * @param roots raíces de la unidad en forma de Montgomery
+ * @param half cantidad de mariposas
+ * @param modulus número primo impar menor que 2^31
+ * @param inverse -modulus^-1 módulo 2^32
+ */
+static void combine_butterflies(uint32_t* even, uint32_t* odd,
+                                uint32_t* roots, uint32_t half,
+                                uint32_t modulus, uint32_t inverse);
+
+/**
+ * @brief Separa un bloque de la transformada en sus dos mitades
+ * @details Es la mariposa inversa de combine_butterflies (decimación en
+ *          frecuencia), se usa en la transformada directa para que su
+ *          resultado quede en el orden de bits invertidos que espera la
+ *          transformada inversa y ninguna de las dos deba reordenar
+ * @code
+ *   split_butterflies(even, odd, roots, half, modulus, inverse);
+ * @endcode
+ * @param even primera mitad del bloque
+ * @param odd segunda mitad del bloque
+ * @param roots raíces de la unidad en forma de Montgomery
+ * @param half cantidad de mariposas
+ * @param modulus número primo impar menor que 2^31
+ * @param inverse -modulus^-1 módulo 2^32
+ */
+static void split_butterflies(uint32_t* even, uint32_t* odd,
+                              uint32_t* roots, uint32_t half,
+                              uint32_t modulus, uint32_t inverse);
+
+void convolution_transform(uint32_t* elements, uint32_t size, uint32_t modulus,
+                           uint32_t root, bool inverse, uint32_t thread_count) {
+  assert(elements);
+  assert(size && (size & (size - 1)) == 0);
+  assert((modulus - 1) % size == 0);
+  /* Precalcular las raíces de la unidad de cada etapa de forma contigua, las
+     de la etapa con mariposas de separación half ocupan [half, 2 * half) */
+  uint32_t* roots = (uint32_t*) malloc(size * sizeof(uint32_t));
+  uint32_t montgomery_inverse = negated_inverse(modulus);
+  // Las raíces se guardan en forma de Montgomery para multiplicar sin dividir
+  for (uint32_t half = 1; half < size; half <<= 1) {
+    uint64_t step = power_mod(root, (modulus - 1) / (2 * half), modulus);
+    if (inverse)
+      step = power_mod(step, modulus - 2, modulus);
+    step = (step << 32) % modulus;
+    roots[half] = (uint32_t) ((1ull << 32) % modulus);
+    for (uint32_t index = half + 1; index < 2 * half; ++index) {
+      roots[index] = montgomery_multiply(roots[index - 1], step, modulus,
+                                         montgomery_inverse);
+    }
+  }
+  /* La transformada directa separa bloques de tamaño decreciente y la
+     inversa combina bloques de tamaño creciente */
+  for (uint32_t level = 0; (1u << level) < size; ++level) {
+    uint32_t half = inverse ? 1u << level : size >> (level + 1);
+    /* Repartir entre los hilos trozos de a lo sumo CONVOLUTION_CHUNK
+       mariposas, de forma que tanto las etapas con muchos bloques pequeños
+       como las etapas con pocos bloques grandes se pueden paralelizar */
+    uint32_t chunk = half < CONVOLUTION_CHUNK ? half : CONVOLUTION_CHUNK;
+    uint32_t chunks_per_block = half / chunk;
+    uint32_t chunk_count = size / (2 * half) * chunks_per_block;
+    #pragma omp parallel for schedule(static) num_threads(thread_count) \
+      default(none) shared(elements, roots, modulus, half, chunk, inverse, \
+      chunks_per_block, chunk_count, montgomery_inverse)
+    for (uint32_t index = 0; index < chunk_count; ++index) {
+      uint32_t offset = index % chunks_per_block * chunk;
+      uint32_t* even = elements + index / chunks_per_block * 2 * half + offset;
+      if (inverse) {
+        combine_butterflies(even, even + half, roots + half + offset, chunk,
+                            modulus, montgomery_inverse);
+      } else {
+        split_butterflies(even, even + half, roots + half + offset, chunk,
+                          modulus, montgomery_inverse);
+      }
+    }
+  }
+  free(roots);
+  // La transformada inversa se divide entre size
+  if (inverse) {
+    uint64_t size_inverse = power_mod(size, modulus - 2, modulus);
+    size_inverse = (size_inverse << 32) % modulus;
+    #pragma omp parallel for schedule(static) num_threads(thread_count) \
+      default(none) shared(elements, size, modulus, size_inverse, \
+      montgomery_inverse)
+    for (uint32_t index = 0; index < size; ++index) {
+      elements[index] = montgomery_multiply(elements[index],
+                        (uint32_t) size_inverse, modulus, montgomery_inverse);
+    }
+  }
+}
+
+void convolution_multiply(uint32_t* left, uint32_t* right, uint32_t size,
+                          uint32_t modulus, uint32_t thread_count) {
+  assert(left);
+  assert(right);
+  uint32_t montgomery_inverse = negated_inverse(modulus);
+  uint32_t correction = (uint32_t) (((uint64_t) 1 << 63) % modulus * 2
+                                    % modulus);
+  /* Multiplicar las transformadas elemento a elemento, la segunda reducción
+     con 2^64 mod modulus compensa el factor 2^-32 de cada reducción */
+  #pragma omp parallel for schedule(static) num_threads(thread_count) \
+    default(none) shared(left, right, size, modulus, correction, \
+    montgomery_inverse)
+  for (uint32_t index = 0; index < size; ++index) {
+    left[index] = montgomery_multiply(montgomery_multiply(left[index],
+                  right[index], modulus, montgomery_inverse), correction,
+                  modulus, montgomery_inverse);
+  }
+}
+
+uint32_t negated_inverse(uint32_t modulus) {
+  uint32_t inverse = 1;
+  // Cada iteración de Newton duplica los bits correctos del inverso
+  for (uint32_t iteration = 0; iteration < 5; ++iteration)
+    inverse *= 2 - modulus * inverse;
+  return -inverse;
+}
+
+uint64_t convolution_size(uint64_t number) {
+  uint64_t size = 1;
+  while (size < number)
+    size <<= 1;
+  return size;
+}
+
+uint32_t power_mod(uint64_t base, uint64_t exponent, uint32_t modulus) {
+  uint64_t result = 1;
+  base %= modulus;
+  // Exponenciación binaria
+  while (exponent) {
+    if (exponent & 1)
+      result = result * base % modulus;
+    base = base * base % modulus;
+    exponent >>= 1;
+  }
+  return (uint32_t) result;
+}
+
+CONVOLUTION_CLONES
+static void combine_butterflies(uint32_t* even, uint32_t* odd,
+                                uint32_t* roots, uint32_t half,
+                                uint32_t modulus, uint32_t inverse) {
+  for (uint32_t index = 0; index < half; ++index) {
+    uint32_t twiddled = montgomery_multiply(odd[index], roots[index],
+                                            modulus, inverse);
+    // Sumar y restar módulo modulus
+    uint32_t left = even[index];
+    uint32_t sum = left + twiddled;
+    even[index] = sum >= modulus ? sum - modulus : sum;
+    odd[index] = left >= twiddled ? left - twiddled
+                                  : left + modulus - twiddled;
+  }
+}
+
+CONVOLUTION_CLONES
+static void split_butterflies(uint32_t* even, uint32_t* odd,
+                              uint32_t* roots, uint32_t half,
+                              uint32_t modulus, uint32_t inverse) {
+  for (uint32_t index = 0; index < half; ++index) {
+    // Sumar y restar módulo modulus
+    uint32_t left = even[index];
+    uint32_t right = odd[index];
+    uint32_t sum = left + right;
+    even[index] = sum >= modulus ? sum - modulus : sum;
+    uint32_t difference = left >= right ? left - right
+                                        : left + modulus - right;
+    odd[index] = montgomery_multiply(difference, roots[index], modulus,
+                                     inverse);
+  }
+}
@@ -0,0 +1,79 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stdbool.h>
+
+/// Primo 7 * 2^26 + 1, admite transformadas de hasta 2^26 elementos
+#define CONVOLUTION_MODULUS 469762049u
+/// Raíz primitiva de CONVOLUTION_MODULUS
+#define CONVOLUTION_ROOT 3u
+/// Tamaño máximo de una transformada con CONVOLUTION_MODULUS
+#define CONVOLUTION_MAX_SIZE (1u << 26)
+/// Primo 5 * 2^25 + 1, con CONVOLUTION_MODULUS permite recuperar con el
+/// Teorema Chino del Residuo resultados de hasta 56 bits
+#define CONVOLUTION_SECOND_MODULUS 167772161u
+/// Raíz primitiva de CONVOLUTION_SECOND_MODULUS
+#define CONVOLUTION_SECOND_ROOT 3u
+/// Tamaño máximo de una transformada con CONVOLUTION_SECOND_MODULUS
+#define CONVOLUTION_SECOND_MAX_SIZE (1u << 25)
+
+/**
+ * @brief Aplica la Transformada Teórico-Numérica (NTT) sobre el arreglo
+ * @details Transforma en sitio los elementos módulo modulus, de forma que
+ *          la convolución de dos arreglos se reduce a multiplicar sus
+ *          transformadas elemento a elemento y aplicar la transformada
+ *          inversa. Todos los cálculos son exactos módulo modulus. La
+ *          transformada directa deja su resultado en orden de bits
+ *          invertidos, que es el orden que espera la inversa, por lo que
+ *          ninguna de las dos necesita reordenar los elementos.
+ * @code
+ *   convolution_transform(elements, 1024, CONVOLUTION_MODULUS,
+ *                         CONVOLUTION_ROOT, false, 8);
+ * @endcode
+ * @param elements arreglo con size elementos menores que modulus
+ * @param size cantidad de elementos, debe ser una potencia de dos que
+ *        divida a modulus - 1
+ * @param modulus número primo de la forma c * 2^k + 1
+ * @param root raíz primitiva de modulus
+ * @param inverse true para aplicar la transformada inversa
+ * @param thread_count cantidad de hilos a emplear
+ */
+void convolution_transform(uint32_t* elements, uint32_t size, uint32_t modulus,
+                           uint32_t root, bool inverse, uint32_t thread_count);
+
+/**
+ * @brief Multiplica elemento a elemento dos arreglos transformados
+ * @details Guarda el resultado en left, el cual puede ser el mismo arreglo
+ *          que right para elevar al cuadrado
+ * @code
+ *   convolution_multiply(left, right, 1024, CONVOLUTION_MODULUS, 8);
+ * @endcode
+ * @param left arreglo que recibe el producto
+ * @param right arreglo a multiplicar
+ * @param size cantidad de elementos de ambos arreglos
+ * @param modulus número primo con el que se transformaron los arreglos
+ * @param thread_count cantidad de hilos a emplear
+ */
+void convolution_multiply(uint32_t* left, uint32_t* right, uint32_t size,
+                          uint32_t modulus, uint32_t thread_count);
+
+/**
+ * @brief Retorna la menor potencia de dos mayor o igual a number
+ * @code
+ *   uint32_t size = convolution_size(1000);
+ *   //Retorna: 1024
+ * @endcode
+ * @param number cantidad mínima de elementos
+ * @return uint64_t potencia de dos
+ */
+uint64_t convolution_size(uint64_t number);
+
+#endif  // !CONVOLUTION_H
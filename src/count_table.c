@@ -0,0 +1,301 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "count_table.h"
+
+/// Consultas a la criba que cuesta en promedio cada mariposa de la NTT
+#define COUNT_TABLE_BUTTERFLY_COST 3
+/// Identificador de los archivos de count_table_save
+#define COUNT_TABLE_FILE_MAGIC "GOLDBACH"
+/// Valor que permite detectar archivos escritos con otro orden de bytes
+#define COUNT_TABLE_BYTE_ORDER 0x01020304u
+
+/**
+ * @brief Encabezado de los archivos de count_table_save
+ * @details Los arreglos strong_counts y weak_counts se guardan a partir de
+ *          strong_offset y weak_offset, alineados a ocho bytes para que se
+ *          puedan leer directamente de la proyección en memoria
+ */
+typedef struct count_file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t limit;
+  uint32_t reserved;
+  uint64_t strong_offset;
+  uint64_t weak_offset;
+} count_file_header_t;
+
+/**
+ * @brief Cuenta los trios de primos impares de cada suma módulo modulus
+ * @details Retorna en la posición k la cantidad de trios ordenados de primos
+ *          impares que suman 2k + 3, más tres veces la cantidad de trios de
+ *          la forma (p, p, r), calculadas a la vez como a * (a^2 + 3b), donde
+ *          a es el indicador de los primos impares y b el mismo indicador
+ *          con sus posiciones duplicadas
+ * @code
+ *   uint32_t* residues = count_triples(sieve, 1024, 4096,
+ *                                      CONVOLUTION_MODULUS, CONVOLUTION_ROOT,
+ *                                      8);
+ * @endcode
+ * @param sieve criba compartida con los números primos
+ * @param length cantidad de sumas a calcular
+ * @param size tamaño de la transformada, al menos 3 * length
+ * @param modulus número primo de la forma c * 2^k + 1
+ * @param root raíz primitiva de modulus
+ * @param thread_count cantidad de hilos a emplear en la convolución
+ * @return uint32_t* arreglo de length residuos, el invocador debe liberarlo
+ */
+uint32_t* count_triples(sieve_t* sieve, uint32_t length, uint32_t size,
+                        uint32_t modulus, uint32_t root,
+                        uint32_t thread_count);
+
+/**
+ * @brief Retorna el inverso multiplicativo de value módulo modulus
+ * @code
+ *   uint64_t inverse = inverse_mod(3, 7);
+ *   //Retorna: 5
+ * @endcode
+ * @param value número a invertir, no divisible por modulus
+ * @param modulus número primo
+ * @return uint64_t inverso de value
+ */
+uint64_t inverse_mod(uint64_t value, uint32_t modulus);
+
+count_table_t* count_table_create(sieve_t* sieve, uint32_t limit,
+                                  uint32_t thread_count) {
+  assert(sieve);
+  assert(limit <= COUNT_TABLE_MAX_LIMIT);
+  assert(limit <= sieve_get_limit(sieve));
+  // Crear e inicializar campos de la estructura
+  count_table_t* table = (count_table_t*) calloc(1, sizeof(count_table_t));
+  uint32_t half_limit = limit / 2;
+  uint32_t size = (uint32_t) convolution_size(2 * (uint64_t) half_limit + 1);
+  uint32_t* elements = (uint32_t*) calloc(size, sizeof(uint32_t));
+  table -> limit = limit;
+  // El elemento i indica si el número impar 2i + 1 es primo
+  for (uint32_t index = 1; index < half_limit; ++index)
+    elements[index] = sieve_is_prime(sieve, 2 * index + 1);
+  /* Elevar al cuadrado el indicador, así el elemento k - 1 cuenta las
+     parejas ordenadas de primos impares (p, q) tales que p + q = 2k */
+  convolution_transform(elements, size, CONVOLUTION_MODULUS, CONVOLUTION_ROOT,
+                        false, thread_count);
+  convolution_multiply(elements, elements, size, CONVOLUTION_MODULUS,
+                       thread_count);
+  convolution_transform(elements, size, CONVOLUTION_MODULUS, CONVOLUTION_ROOT,
+                        true, thread_count);
+  /* Convertir parejas ordenadas en sumas p <= q, reutilizando el arreglo
+     de atrás hacia adelante pues la suma 2k se obtiene del elemento k - 1 */
+  for (uint32_t index = half_limit; index > 0; --index) {
+    uint32_t twins = index % 2 == 1 && sieve_is_prime(sieve, index);
+    elements[index] = (elements[index - 1] + twins) / 2;
+  }
+  elements[0] = 0;
+  // Liberar la parte del arreglo que solo se necesitaba para convolucionar
+  uint32_t* strong_counts = (uint32_t*) realloc(elements,
+                            ((uint64_t) half_limit + 1) * sizeof(uint32_t));
+  table -> strong_counts = strong_counts ? strong_counts : elements;
+  return table;
+}
+
+count_table_t* count_table_precompute(sieve_t* sieve, uint32_t limit,
+                                      uint32_t thread_count) {
+  assert(limit <= COUNT_TABLE_MAX_FILE_LIMIT);
+  // Calcular las sumas fuertes con una tabla convencional
+  count_table_t* table = count_table_create(sieve, limit, thread_count);
+  uint32_t half_limit = limit / 2;
+  table -> weak_counts = (uint64_t*) calloc((uint64_t) half_limit + 1,
+                                            sizeof(uint64_t));
+  if (half_limit < 2)
+    return table;
+  /* Contar los trios de primos impares que suman 2k + 3 con dos módulos,
+     el mayor impar de la tabla es 2 (half_limit - 1) + 3 */
+  uint32_t length = half_limit;
+  uint32_t size = (uint32_t) convolution_size(3 * (uint64_t) length);
+  uint32_t* residues = count_triples(sieve, length, size, CONVOLUTION_MODULUS,
+                                     CONVOLUTION_ROOT, thread_count);
+  uint32_t* second_residues = count_triples(sieve, length, size,
+                                            CONVOLUTION_SECOND_MODULUS,
+                                            CONVOLUTION_SECOND_ROOT,
+                                            thread_count);
+  uint64_t inverse = inverse_mod(CONVOLUTION_MODULUS,
+                                 CONVOLUTION_SECOND_MODULUS);
+  for (uint32_t index = 3; index < half_limit + 1; ++index) {
+    uint64_t number = 2 * (uint64_t) index + 1;
+    if (number > limit)
+      break;
+    // Recuperar el valor exacto con el Teorema Chino del Residuo
+    uint64_t first = residues[index - 1];
+    uint64_t second = second_residues[index - 1];
+    uint64_t difference = (second + CONVOLUTION_SECOND_MODULUS -
+                           first % CONVOLUTION_SECOND_MODULUS) %
+                          CONVOLUTION_SECOND_MODULUS;
+    uint64_t triples = first + (uint64_t) CONVOLUTION_MODULUS *
+                       (difference * inverse % CONVOLUTION_SECOND_MODULUS);
+    // Lema de Burnside: sumar dos veces el trio (p, p, p) y dividir entre 6
+    if (number % 3 == 0 && sieve_is_prime(sieve, number / 3))
+      triples += 2;
+    assert(triples % 6 == 0);
+    table -> weak_counts[index] = triples / 6 +
+                                  sieve_is_prime(sieve, number - 4);
+  }
+  free(residues);
+  free(second_residues);
+  return table;
+}
+
+uint32_t* count_triples(sieve_t* sieve, uint32_t length, uint32_t size,
+                        uint32_t modulus, uint32_t root,
+                        uint32_t thread_count) {
+  uint32_t* primes = (uint32_t*) calloc(size, sizeof(uint32_t));
+  uint32_t* doubled = (uint32_t*) calloc(size, sizeof(uint32_t));
+  // El elemento i indica si el número impar 2i + 1 es primo
+  for (uint32_t index = 1; index < length; ++index) {
+    primes[index] = sieve_is_prime(sieve, 2 * index + 1);
+    if (2 * (uint64_t) index < length)
+      doubled[2 * index] = primes[index];
+  }
+  convolution_transform(primes, size, modulus, root, false, thread_count);
+  convolution_transform(doubled, size, modulus, root, false, thread_count);
+  // Calcular a * (a^2 + 3b) en el dominio de la transformada
+  for (uint32_t index = 0; index < size; ++index) {
+    doubled[index] = ((uint64_t) primes[index] * primes[index] +
+                      3 * (uint64_t) doubled[index]) % modulus;
+  }
+  convolution_multiply(doubled, primes, size, modulus, thread_count);
+  convolution_transform(doubled, size, modulus, root, true, thread_count);
+  free(primes);
+  // Liberar la parte del arreglo que solo se necesitaba para convolucionar
+  uint32_t* residues = (uint32_t*) realloc(doubled,
+                                           length * sizeof(uint32_t));
+  return residues ? residues : doubled;
+}
+
+uint64_t inverse_mod(uint64_t value, uint32_t modulus) {
+  uint64_t result = 1;
+  uint64_t base = value % modulus;
+  // Pequeño Teorema de Fermat: value^-1 = value^(modulus - 2)
+  for (uint64_t exponent = modulus - 2; exponent; exponent >>= 1) {
+    if (exponent & 1)
+      result = result * base % modulus;
+    base = base * base % modulus;
+  }
+  return result;
+}
+
+bool count_table_save(count_table_t* table, const char* path) {
+  assert(table);
+  assert(table -> weak_counts);
+  uint64_t element_count = (uint64_t) table -> limit / 2 + 1;
+  count_file_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, COUNT_TABLE_FILE_MAGIC, sizeof(header.magic));
+  header.version = COUNT_TABLE_FILE_VERSION;
+  header.byte_order = COUNT_TABLE_BYTE_ORDER;
+  header.limit = table -> limit;
+  header.strong_offset = sizeof(header);
+  header.weak_offset = (header.strong_offset + element_count *
+                        sizeof(uint32_t) + 7) / 8 * 8;
+  FILE* file = fopen(path, "wb");
+  if (!file)
+    return false;
+  // Escribir el encabezado y los arreglos en sus posiciones
+  const uint64_t padding = 0;
+  uint64_t padding_size = header.weak_offset - header.strong_offset -
+                          element_count * sizeof(uint32_t);
+  bool is_written =
+    fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(table -> strong_counts, sizeof(uint32_t), element_count, file)
+      == element_count &&
+    fwrite(&padding, 1, padding_size, file) == padding_size &&
+    fwrite(table -> weak_counts, sizeof(uint64_t), element_count, file)
+      == element_count;
+  return fclose(file) == 0 && is_written;
+}
+
+count_table_t* count_table_load(const char* path) {
+  int file = open(path, O_RDONLY);
+  if (file < 0)
+    return NULL;
+  struct stat status;
+  count_table_t* table = NULL;
+  void* mapping = MAP_FAILED;
+  // Proyectar el archivo completo en memoria de solo lectura
+  if (fstat(file, &status) == 0 &&
+      (uint64_t) status.st_size >= sizeof(count_file_header_t)) {
+    mapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+  }
+  close(file);
+  if (mapping == MAP_FAILED)
+    return NULL;
+  // Validar el formato, la versión y que los arreglos quepan en el archivo
+  count_file_header_t* header = (count_file_header_t*) mapping;
+  uint64_t element_count = (uint64_t) header -> limit / 2 + 1;
+  if (memcmp(header -> magic, COUNT_TABLE_FILE_MAGIC, sizeof(header -> magic))
+      == 0 && header -> version == COUNT_TABLE_FILE_VERSION &&
+      header -> byte_order == COUNT_TABLE_BYTE_ORDER &&
+      header -> limit <= COUNT_TABLE_MAX_FILE_LIMIT &&
+      header -> strong_offset % 8 == 0 && header -> weak_offset % 8 == 0 &&
+      header -> strong_offset + element_count * sizeof(uint32_t) <=
+        header -> weak_offset &&
+      header -> weak_offset + element_count * sizeof(uint64_t) <=
+        (uint64_t) status.st_size) {
+    table = (count_table_t*) calloc(1, sizeof(count_table_t));
+    table -> limit = header -> limit;
+    table -> strong_counts = (uint32_t*) ((char*) mapping +
+                                          header -> strong_offset);
+    table -> weak_counts = (uint64_t*) ((char*) mapping +
+                                        header -> weak_offset);
+    table -> mapping = mapping;
+    table -> mapping_size = status.st_size;
+  } else {
+    munmap(mapping, status.st_size);
+  }
+  return table;
+}
+
+void count_table_destroy(count_table_t* table) {
+  assert(table);
+  // Liberar memoria empleada por la estructura
+  if (table -> mapping) {
+    munmap(table -> mapping, table -> mapping_size);
+  } else {
+    free(table -> strong_counts);
+    free(table -> weak_counts);
+  }
+  free(table);
+}
+
+bool count_table_has_count(count_table_t* table, uint64_t number,
+                           bool even_number) {
+  assert(table);
+  // Los impares solo se guardan en las tablas precalculadas
+  return number <= table -> limit && (even_number || table -> weak_counts);
+}
+
+bool count_table_get_count(count_table_t* table, uint64_t number,
+                           bool even_number, uint64_t* count) {
+  assert(table);
+  assert(count);
+  // Solo se guardan las sumas de los valores dentro del límite
+  if (!count_table_has_count(table, number, even_number))
+    return false;
+  *count = even_number ? table -> strong_counts[number / 2]
+                       : table -> weak_counts[number / 2];
+  return true;
+}
+
+uint32_t count_table_get_limit(count_table_t* table) {
+  assert(table);
+  return table -> limit;  // Retornar campo limit de table
+}
+
+uint64_t count_table_estimate_cost(uint32_t limit) {
+  uint64_t size = convolution_size(2 * (uint64_t) (limit / 2) + 1);
+  uint64_t levels = 0;
+  while ((1ull << levels) < size)
+    ++levels;
+  // Dos transformadas de size / 2 mariposas por cada nivel
+  return COUNT_TABLE_BUTTERFLY_COST * size * levels;
+}
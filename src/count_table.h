@@ -0,0 +1,179 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef COUNT_TABLE_H
+#define COUNT_TABLE_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sieve.h"
+#include "convolution.h"
+
+/// Mayor valor par que admite una tabla calculada con una sola convolución
+#define COUNT_TABLE_MAX_LIMIT (CONVOLUTION_MAX_SIZE - 2)
+/// Mayor valor que admite una tabla precalculada con sumas débiles, pues
+/// sus convoluciones abarcan 3 * limit / 2 elementos
+#define COUNT_TABLE_MAX_FILE_LIMIT (1u << 24)
+/// Versión del formato de los archivos de count_table_save
+#define COUNT_TABLE_FILE_VERSION 1
+
+/**
+ * @brief Estructura de datos que guarda la cantidad de Sumas de Goldbach
+ *        fuertes de todos los números pares hasta un límite
+ * @details La cantidad de sumas de n = 2k se guarda en strong_counts[k]. Se
+ *          calculan todas a la vez convolucionando el indicador de los
+ *          números primos impares consigo mismo, de forma que responder un
+ *          valor par del lote se reduce a consultar el arreglo. Las tablas
+ *          precalculadas guardan además en weak_counts[k] la cantidad de
+ *          sumas débiles del impar 2k + 1, y al cargarse de un archivo ambos
+ *          arreglos apuntan a la proyección en memoria de este.
+ */
+typedef struct count_table {
+  uint32_t limit;
+  uint32_t* strong_counts;
+  uint64_t* weak_counts;
+  void* mapping;
+  size_t mapping_size;
+} count_table_t;
+
+/**
+ * @brief Constructor, calcula la cantidad de sumas fuertes de cada número
+ *        par menor o igual a limit
+ * @code
+ *   count_table_t* table = count_table_create(sieve, 10000000, 8);
+ * @endcode
+ * @param sieve criba compartida con los números primos hasta al menos limit
+ * @param limit mayor número par a calcular, a lo sumo COUNT_TABLE_MAX_LIMIT
+ * @param thread_count cantidad de hilos a emplear en la convolución
+ * @return count_table_t* estructura de datos
+ */
+count_table_t* count_table_create(sieve_t* sieve, uint32_t limit,
+                                  uint32_t thread_count);
+
+/**
+ * @brief Constructor, calcula la cantidad de sumas fuertes y débiles de cada
+ *        número menor o igual a limit
+ * @details Las sumas débiles de un impar n son los trios de primos impares
+ *          más el trio 2 + 2 + (n - 4). Los trios ordenados de primos impares
+ *          se obtienen elevando al cubo el indicador de los primos y con el
+ *          Lema de Burnside se convierten en trios p <= q <= r. Como pueden
+ *          exceder al módulo de la convolución, se calculan con dos módulos
+ *          y se combinan con el Teorema Chino del Residuo.
+ * @code
+ *   count_table_t* table = count_table_precompute(sieve, 1000000, 8);
+ * @endcode
+ * @param sieve criba compartida con los números primos hasta al menos limit
+ * @param limit mayor número a calcular, a lo sumo COUNT_TABLE_MAX_FILE_LIMIT
+ * @param thread_count cantidad de hilos a emplear en las convoluciones
+ * @return count_table_t* estructura de datos
+ */
+count_table_t* count_table_precompute(sieve_t* sieve, uint32_t limit,
+                                      uint32_t thread_count);
+
+/**
+ * @brief Escribe una tabla precalculada en un archivo binario
+ * @details El archivo inicia con un encabezado que indica el formato, su
+ *          versión, el orden de los bytes y el límite, seguido de los
+ *          arreglos strong_counts y weak_counts tal como están en memoria
+ * @code
+ *   bool saved = count_table_save(table, "goldbach.table");
+ * @endcode
+ * @param table tabla creada con count_table_precompute
+ * @param path ruta del archivo a escribir
+ * @return
+ *   true: si se pudo escribir el archivo
+ *   false: si ocurrió un error al escribirlo
+ */
+bool count_table_save(count_table_t* table, const char* path);
+
+/**
+ * @brief Constructor, proyecta en memoria una tabla escrita por
+ *        count_table_save
+ * @details Los arreglos no se copian, las páginas se leen del archivo la
+ *          primera vez que se consultan
+ * @code
+ *   count_table_t* table = count_table_load("goldbach.table");
+ * @endcode
+ * @param path ruta del archivo a cargar
+ * @return count_table_t* estructura de datos, o NULL si el archivo no existe
+ *         o no tiene un formato válido
+ */
+count_table_t* count_table_load(const char* path);
+
+/**
+ * @brief Destructor, libera la memoria de la estructura
+ * @code
+ *   count_table_destroy(table);
+ * @endcode
+ * @param table estructura de datos
+ */
+void count_table_destroy(count_table_t* table);
+
+/**
+ * @brief Indica si la tabla contiene la cantidad de Sumas de Goldbach de
+ *        number
+ * @code
+ *   bool has_count = count_table_has_count(table, 10, true);
+ * @endcode
+ * @param table estructura de datos
+ * @param number número a consultar
+ * @param even_number booleano que indica si number es par o impar
+ * @return
+ *   true: si count_table_get_count encontraría el valor
+ *   false: si el valor está fuera de la tabla y debe calcularse
+ */
+bool count_table_has_count(count_table_t* table, uint64_t number,
+                           bool even_number);
+
+/**
+ * @brief Busca en la tabla la cantidad de Sumas de Goldbach de number
+ * @code
+ *   uint64_t count = 0;
+ *   if (count_table_get_count(table, 10, true, &count)) {
+ *     //count vale 2
+ *   }
+ * @endcode
+ * @param table estructura de datos
+ * @param number número a consultar
+ * @param even_number booleano que indica si number es par o impar
+ * @param count dirección donde se guarda la cantidad encontrada
+ * @return
+ *   true: si la tabla contiene el valor solicitado
+ *   false: si el valor está fuera de la tabla y debe calcularse
+ */
+bool count_table_get_count(count_table_t* table, uint64_t number,
+                           bool even_number, uint64_t* count);
+
+/**
+ * @brief Retorna el mayor número de la tabla
+ * @code
+ *   uint32_t limit = count_table_get_limit(table);
+ * @endcode
+ * @param table estructura de datos
+ * @return uint32_t límite de la tabla
+ */
+uint32_t count_table_get_limit(count_table_t* table);
+
+/**
+ * @brief Estima el costo de construir una tabla hasta limit
+ * @details Se expresa en las mismas unidades que sieve_count_primes, es
+ *          decir, en consultas a la criba, para que el solver lo compare con
+ *          el costo de calcular cada valor por separado
+ * @code
+ *   uint64_t cost = count_table_estimate_cost(10000000);
+ * @endcode
+ * @param limit mayor número par de la tabla
+ * @return uint64_t costo estimado
+ */
+uint64_t count_table_estimate_cost(uint32_t limit);
+
+#endif  // !COUNT_TABLE_H
@@ -0,0 +1,413 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "engine_internal.h"
+
+/**
+ * @brief Campos de engine_t, que solo conocen los módulos del programa
+ *        mediante las funciones de engine_internal.h
+ * @details sieve_mutex protege los arreglos sieves e is_building, pero
+ *          cada criba se construye fuera de él y quienes necesitan el mismo
+ *          índice esperan en sieve_built. El caché de resultados tiene su
+ *          propio mutex y la tabla solo se lee.
+ */
+typedef struct engine {
+  uint32_t thread_count;
+  sieve_t* sieves[ENGINE_SIEVE_COUNT];
+  bool is_building[ENGINE_SIEVE_COUNT];
+  result_cache_t* cache;
+  bool owns_cache;
+  count_table_t* table;
+  pool_t* pool;
+  pthread_mutex_t sieve_mutex;
+  pthread_cond_t sieve_built;
+} engine_t;
+
+/// Datos del lote que recibe engine_compute_entry
+typedef struct engine_job {
+  goldbach_t** entries;
+  uint32_t* order;
+  sieve_t* sieve;
+  count_table_t* table;
+  result_cache_t* cache;
+  stats_t* stats;
+} engine_job_t;
+
+/**
+ * @brief Retorna una criba que abarque a value, creándola si no existe
+ * @details La criba del índice i tiene un límite desde
+ *          ENGINE_MIN_SIEVE_LIMIT * 2^i hasta antes del doble, por lo que
+ *          se busca la menor que abarque a value desde el índice de value.
+ *          Si ninguna lo abarca, se crea con el límite exacto cuando se
+ *          solicita y su índice está libre, o si no con la potencia de dos
+ *          siguiente. La criba se construye sin el mutex, de forma que las
+ *          consultas que ya tienen su criba no esperan a la de otra; solo
+ *          quien necesita el índice que se está construyendo espera a que
+ *          termine y vuelve a buscar.
+ * @code
+ *   sieve_t* sieve = engine_find_sieve(engine, 100000, false);
+ * @endcode
+ * @param engine estructura de datos
+ * @param value mayor valor que se calculará con la criba
+ * @param is_exact true para crear la criba con el límite value
+ * @return sieve_t* criba con límite mayor o igual a value o SIEVE_MAX_LIMIT
+ */
+sieve_t* engine_find_sieve(engine_t* engine, uint64_t value, bool is_exact);
+
+/**
+ * @brief Retorna el valor que debe abarcar la criba de la entrada
+ * @code
+ *   uint64_t value = engine_get_sieve_value(engine, goldbach);
+ * @endcode
+ * @param engine estructura de datos
+ * @param goldbach entrada a calcular
+ * @return uint64_t valor de la entrada, o cero si la tabla la responde
+ */
+uint64_t engine_get_sieve_value(engine_t* engine, goldbach_t* goldbach);
+
+/**
+ * @brief Construye la tabla de sumas fuertes de un lote si resulta más
+ *        barata
+ * @details Estima con goldbach_estimate_cost el costo de calcular por
+ *          separado cada valor par del lote y solo si supera el costo de
+ *          una convolución construye una tabla con la cantidad de sumas de
+ *          todos los pares hasta el mayor de ellos
+ * @code
+ *   count_table_t* table = engine_create_table(engine, entries, count,
+ *                                              sieve);
+ * @endcode
+ * @param engine estructura de datos
+ * @param entries entradas del lote
+ * @param entry_count cantidad de entradas
+ * @param sieve criba del lote
+ * @return count_table_t* tabla del lote, que se debe destruir con
+ *         count_table_destroy, o NULL si no conviene
+ */
+count_table_t* engine_create_table(engine_t* engine, goldbach_t** entries,
+                                   uint32_t entry_count, sieve_t* sieve);
+
+/**
+ * @brief Ordena las entradas de un lote de la más cara a la más barata
+ * @details Estima el costo de cada entrada con goldbach_estimate_cost y las
+ *          ordena de forma descendente, de modo que el ciclo dinámico
+ *          reparte primero el trabajo más largo y las entradas baratas
+ *          rellenan al final. Las entradas repetidas solo copian el
+ *          resultado del caché, por lo que se mueven al final del orden en
+ *          lugar de esperar a la primera ocurrencia al mismo tiempo.
+ * @code
+ *   uint32_t* order = engine_schedule(entries, count, sieve, table);
+ * @endcode
+ * @param entries entradas del lote
+ * @param entry_count cantidad de entradas
+ * @param sieve criba del lote
+ * @param table tabla de cantidades del lote, puede ser NULL
+ * @return uint32_t* índices de las entradas en el orden de cálculo, se deben
+ *         liberar con free
+ */
+uint32_t* engine_schedule(goldbach_t** entries, uint32_t entry_count,
+                          sieve_t* sieve, count_table_t* table);
+
+/**
+ * @brief Calcula una entrada del lote en el orden de engine_schedule
+ * @details Es el cuerpo del ciclo de OpenMP y la tarea de pool_t. Con
+ *          mediciones suma el tiempo y los contadores de la entrada al hilo
+ *          que la calcula.
+ * @code
+ *   engine_compute_entry(&job, index, omp_get_thread_num());
+ * @endcode
+ * @param data estructura engine_job_t
+ * @param index posición de la entrada en el orden de cálculo
+ * @param thread número del hilo que la calcula
+ */
+void engine_compute_entry(void* data, uint32_t index, uint32_t thread);
+
+engine_t* engine_create(uint32_t thread_count) {
+  return engine_create_shared(thread_count, NULL, NULL, NULL);
+}
+
+engine_t* engine_create_shared(uint32_t thread_count, result_cache_t* cache,
+                               count_table_t* table, pool_t* pool) {
+  // Crear e inicializar campos de la estructura
+  engine_t* engine = (engine_t*) calloc(1, sizeof(engine_t));
+  engine -> thread_count = thread_count ? thread_count
+                           : (uint32_t) sysconf(_SC_NPROCESSORS_ONLN);
+  engine -> owns_cache = !cache;
+  engine -> cache = cache ? cache : result_cache_create();
+  engine -> table = table;
+  engine -> pool = pool;
+  pthread_mutex_init(&engine -> sieve_mutex, NULL);
+  pthread_cond_init(&engine -> sieve_built, NULL);
+  return engine;
+}
+
+uint64_t engine_count(engine_t* engine, uint64_t value) {
+  assert(engine);
+  goldbach_t* goldbach = goldbach_create_value(value, false, NULL);
+  result_cache_run(engine -> cache, goldbach,
+                   engine_get_sieve(engine, goldbach), engine -> table);
+  uint64_t count = goldbach_get_count(goldbach);
+  goldbach_destroy(goldbach);
+  return count;
+}
+
+uint64_t engine_enumerate(engine_t* engine, uint64_t value,
+                          engine_visitor_t visitor, void* data) {
+  assert(engine);
+  assert(visitor);
+  // Las entradas negativas listan sus sumas, por lo que no usan la tabla
+  goldbach_t* goldbach = goldbach_create_value(value, true, NULL);
+  uint64_t count = goldbach_enumerate(goldbach,
+                                      engine_get_sieve(engine, goldbach),
+                                      visitor, data);
+  goldbach_destroy(goldbach);
+  return count;
+}
+
+void engine_count_batch(engine_t* engine, const uint64_t* values,
+                        uint32_t value_count, uint64_t* counts) {
+  assert(engine);
+  arena_t arena;
+  arena_init(&arena);
+  goldbach_t** entries = (goldbach_t**) malloc((value_count + 1)
+                                               * sizeof(goldbach_t*));
+  // Calcular las entradas como un lote del programa, sin mediciones
+  for (uint32_t index = 0; index < value_count; ++index)
+    entries[index] = goldbach_create_value(values[index], false, &arena);
+  engine_compute(engine, entries, value_count, NULL);
+  for (uint32_t index = 0; index < value_count; ++index)
+    counts[index] = goldbach_get_count(entries[index]);
+  free(entries);
+  // Las entradas se liberan de una vez junto con el arena
+  arena_destroy(&arena);
+}
+
+void engine_compute(engine_t* engine, goldbach_t** entries,
+                    uint32_t entry_count, stats_t* stats) {
+  assert(engine);
+  stats_mark_t start;
+  stats_mark(stats, &start);
+  sieve_t* sieve = engine_get_batch_sieve(engine, entries, entry_count);
+  if (stats)
+    stats_add_phase(stats, STATS_SIEVE, &start);
+  // Una tabla precalculada reemplaza a la del lote
+  stats_mark(stats, &start);
+  count_table_t* batch_table = engine -> table ? NULL
+                               : engine_create_table(engine, entries,
+                                                     entry_count, sieve);
+  if (stats)
+    stats_add_phase(stats, STATS_TABLE, &start);
+  stats_mark(stats, &start);
+  count_table_t* table = batch_table ? batch_table : engine -> table;
+  engine_job_t job = {entries, engine_schedule(entries, entry_count, sieve,
+                                               table),
+                      sieve, table, engine -> cache, stats};
+  if (stats)
+    stats_add_phase(stats, STATS_SCHEDULE, &start);
+  /* Cálculo de sumas de Goldbach de la entrada más cara a la más barata, los
+     valores repetidos se calculan una vez */
+  stats_mark(stats, &start);
+  if (engine -> pool) {
+    pool_run(engine -> pool, entry_count, engine_compute_entry, &job);
+  } else {
+    #pragma omp parallel for schedule(dynamic) \
+      num_threads(engine -> thread_count) default(none) \
+      shared(entry_count, job)
+      for (uint32_t index = 0; index < entry_count; ++index)
+        engine_compute_entry(&job, index, omp_get_thread_num());
+  }
+  if (stats)
+    stats_add_phase(stats, STATS_SUMS, &start);
+  free(job.order);
+  if (batch_table)
+    count_table_destroy(batch_table);
+}
+
+void engine_compute_entry(void* data, uint32_t index, uint32_t thread) {
+  engine_job_t* job = (engine_job_t*) data;
+  goldbach_t* goldbach = job -> entries[job -> order[index]];
+  stats_mark_t start;
+  if (job -> stats)
+    stats_start_busy(job -> stats, &start);
+  result_cache_run(job -> cache, goldbach, job -> sieve, job -> table);
+  if (job -> stats) {
+    stats_add_busy(job -> stats, thread, &start,
+                   goldbach_get_value(goldbach));
+  }
+}
+
+uint32_t engine_get_thread_count(engine_t* engine) {
+  assert(engine);
+  return engine -> thread_count;
+}
+
+result_cache_t* engine_get_cache(engine_t* engine) {
+  assert(engine);
+  return engine -> cache;
+}
+
+count_table_t* engine_get_table(engine_t* engine) {
+  assert(engine);
+  return engine -> table;
+}
+
+pool_t* engine_get_pool(engine_t* engine) {
+  assert(engine);
+  return engine -> pool;
+}
+
+sieve_t* engine_get_sieve(engine_t* engine, goldbach_t* goldbach) {
+  assert(engine);
+  return engine_find_sieve(engine, engine_get_sieve_value(engine, goldbach),
+                           false);
+}
+
+sieve_t* engine_get_batch_sieve(engine_t* engine, goldbach_t** entries,
+                                uint32_t entry_count) {
+  assert(engine);
+  uint64_t max_value = 0;
+  // Encontrar el mayor valor válido del lote que la tabla no responde
+  for (uint32_t index = 0; index < entry_count; ++index) {
+    uint64_t value = engine_get_sieve_value(engine, entries[index]);
+    if (value > max_value)
+      max_value = value;
+  }
+  return engine_find_sieve(engine, max_value, true);
+}
+
+uint64_t engine_get_sieve_value(engine_t* engine, goldbach_t* goldbach) {
+  uint64_t value = goldbach_get_value(goldbach);
+  /* Las entradas que responde la tabla no requieren una criba mayor, salvo
+     si listan sus sumas */
+  if (engine -> table && !goldbach_is_listed(goldbach) &&
+      count_table_has_count(engine -> table, value, value % 2 == 0))
+    value = 0;
+  return value;
+}
+
+sieve_t* engine_find_sieve(engine_t* engine, uint64_t value, bool is_exact) {
+  /* Los primos hasta SIEVE_MAX_LIMIT bastan para cribar por segmentos y
+     validar cualquier valor mayor */
+  if (value > SIEVE_MAX_LIMIT)
+    value = SIEVE_MAX_LIMIT;
+  uint32_t index = 0;
+  // Buscar el índice de value, con límite ENGINE_MIN_SIEVE_LIMIT * 2^index
+  while (index + 1 < ENGINE_SIEVE_COUNT &&
+         ((uint64_t) ENGINE_MIN_SIEVE_LIMIT << (index + 1)) <= value)
+    ++index;
+  pthread_mutex_lock(&engine -> sieve_mutex);
+  sieve_t* sieve = NULL;
+  while (!sieve) {
+    for (uint32_t next = index; next < ENGINE_SIEVE_COUNT && !sieve; ++next) {
+      if (engine -> sieves[next] &&
+          sieve_get_limit(engine -> sieves[next]) >= value)
+        sieve = engine -> sieves[next];
+    }
+    if (sieve)
+      break;
+    // Elegir el índice y el límite de la criba a crear
+    uint32_t slot = index;
+    uint64_t limit = (uint64_t) ENGINE_MIN_SIEVE_LIMIT << index;
+    if (is_exact && !engine -> sieves[index]) {
+      // Un límite menor que el de la primera criba no ahorra memoria
+      if (value > limit)
+        limit = value;
+    } else if (limit < value) {
+      limit = (uint64_t) ENGINE_MIN_SIEVE_LIMIT << ++slot;
+    }
+    // Si otro hilo construye ese índice esperarlo y volver a buscar
+    if (engine -> is_building[slot]) {
+      pthread_cond_wait(&engine -> sieve_built, &engine -> sieve_mutex);
+      continue;
+    }
+    engine -> is_building[slot] = true;
+    pthread_mutex_unlock(&engine -> sieve_mutex);
+    sieve = sieve_create((uint32_t) limit);
+    pthread_mutex_lock(&engine -> sieve_mutex);
+    engine -> sieves[slot] = sieve;
+    engine -> is_building[slot] = false;
+    pthread_cond_broadcast(&engine -> sieve_built);
+  }
+  pthread_mutex_unlock(&engine -> sieve_mutex);
+  return sieve;
+}
+
+count_table_t* engine_create_table(engine_t* engine, goldbach_t** entries,
+                                   uint32_t entry_count, sieve_t* sieve) {
+  uint64_t separate_cost = 0;
+  uint32_t max_value = 0;
+  // Estimar el costo de calcular por separado cada valor par positivo
+  for (uint32_t index = 0; index < entry_count; ++index) {
+    uint64_t value = goldbach_get_value(entries[index]);
+    if (value > 5 && value % 2 == 0 && value <= COUNT_TABLE_MAX_LIMIT) {
+      separate_cost += goldbach_estimate_cost(entries[index], sieve, NULL);
+      if (value > max_value)
+        max_value = (uint32_t) value;
+    }
+  }
+  // Construir la tabla solo si una convolución es más barata
+  if (max_value && separate_cost > count_table_estimate_cost(max_value))
+    return count_table_create(sieve, max_value, engine -> thread_count);
+  return NULL;
+}
+
+uint32_t* engine_schedule(goldbach_t** entries, uint32_t entry_count,
+                          sieve_t* sieve, count_table_t* table) {
+  engine_task_t* tasks = (engine_task_t*) malloc((entry_count + 1)
+                                                 * sizeof(engine_task_t));
+  uint32_t* order = (uint32_t*) malloc((entry_count + 1) * sizeof(uint32_t));
+  uint32_t task_count = 0;
+  uint32_t cheap_count = 0;
+  /* Estimar el costo de cada entrada, las que no requieren cálculo van al
+     final en el orden de entrada y solo se ordenan las demás */
+  for (uint32_t index = 0; index < entry_count; ++index) {
+    uint64_t cost = goldbach_estimate_cost(entries[index], sieve, table);
+    if (cost > 1) {
+      tasks[task_count].cost = cost;
+      tasks[task_count].value = goldbach_get_value(entries[index]);
+      tasks[task_count++].index = index;
+    } else {
+      order[cheap_count++] = index;
+    }
+  }
+  memmove(order + task_count, order, cheap_count * sizeof(uint32_t));
+  qsort(tasks, task_count, sizeof(engine_task_t), engine_compare_tasks);
+  // Mover al final las repeticiones, que solo copian el resultado del caché
+  uint32_t count = 0;
+  for (uint32_t pass = 0; pass < 2; ++pass) {
+    for (uint32_t index = 0; index < task_count; ++index) {
+      bool is_repeated = index > 0 &&
+                         tasks[index].value == tasks[index - 1].value;
+      if (is_repeated == (pass == 1))
+        order[count++] = tasks[index].index;
+    }
+  }
+  free(tasks);
+  return order;
+}
+
+int engine_compare_tasks(const void* left, const void* right) {
+  const engine_task_t* first = (const engine_task_t*) left;
+  const engine_task_t* second = (const engine_task_t*) right;
+  // Costo descendente, luego valor y posición ascendentes
+  if (first -> cost != second -> cost)
+    return first -> cost > second -> cost ? -1 : 1;
+  if (first -> value != second -> value)
+    return first -> value < second -> value ? -1 : 1;
+  return first -> index < second -> index ? -1
+         : first -> index > second -> index;
+}
+
+void engine_destroy(engine_t* engine) {
+  assert(engine);
+  // Liberar memoria empleada por la estructura
+  for (uint32_t index = 0; index < ENGINE_SIEVE_COUNT; ++index) {
+    if (engine -> sieves[index])
+      sieve_destroy(engine -> sieves[index]);
+  }
+  if (engine -> owns_cache)
+    result_cache_destroy(engine -> cache);
+  pthread_mutex_destroy(&engine -> sieve_mutex);
+  pthread_cond_destroy(&engine -> sieve_built);
+  free(engine);
+}
@@ -0,0 +1,113 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef ENGINE_H
+#define ENGINE_H
+#include <stdint.h>
+
+/// Marca las funciones que exporta libgoldbach, las demás quedan ocultas
+#define ENGINE_API __attribute__((visibility("default")))
+
+/**
+ * @brief Estructura de datos con el contexto de primos que comparten todas
+ *        las consultas, para usar el cálculo sin la entrada ni la salida
+ *        estándar
+ * @details Es la interfaz de la biblioteca libgoldbach: recibe valores como
+ *          números y entrega cantidades o sumas a una función, sin analizar
+ *          cadenas ni imprimir. Sus campos no forman parte de la interfaz,
+ *          por lo que este encabezado no depende de los demás módulos. Las
+ *          cribas crecen duplicando su límite a medida que se consultan
+ *          valores mayores y se conservan hasta destruir la estructura.
+ *          Todas las funciones se pueden invocar desde varios hilos a la
+ *          vez. El modo por flujo y el servidor del programa se construyen
+ *          sobre esta estructura mediante engine_internal.h.
+ */
+typedef struct engine engine_t;
+
+/**
+ * @brief Función que recibe cada suma enumerada por engine_enumerate
+ * @code
+ *   void print_sum(void* data, const uint64_t* addends, uint32_t count);
+ * @endcode
+ * @param data datos del receptor indicados a engine_enumerate
+ * @param addends sumandos de la suma en orden ascendente
+ * @param count cantidad de sumandos, dos en las sumas fuertes y tres en las
+ *        débiles
+ */
+typedef void (*engine_visitor_t)(void* data, const uint64_t* addends,
+                                 uint32_t count);
+
+/**
+ * @brief Constructor, inicializa los campos de la estructura con un caché
+ *        de resultados propio
+ * @code
+ *   engine_t* engine = engine_create(8);
+ * @endcode
+ * @param thread_count cantidad de hilos de engine_count_batch, o cero para
+ *        usar todos los procesadores
+ * @return engine_t* estructura de datos
+ */
+ENGINE_API engine_t* engine_create(uint32_t thread_count);
+
+/**
+ * @brief Retorna la cantidad de Sumas de Goldbach de value
+ * @details Los valores pares cuentan sumas de dos primos y los impares de
+ *          tres. Los resultados se guardan en el caché, por lo que consultar
+ *          de nuevo un valor no lo recalcula.
+ * @code
+ *   uint64_t count = engine_count(engine, 1000000);
+ * @endcode
+ * @param engine estructura de datos
+ * @param value valor a calcular
+ * @return uint64_t cantidad de sumas, o cero si value es menor que seis o
+ *         mayor que 2^34, o que 2^26 si es impar
+ */
+ENGINE_API uint64_t engine_count(engine_t* engine, uint64_t value);
+
+/**
+ * @brief Entrega a visitor cada Suma de Goldbach de value en orden
+ *        ascendente, sin guardarlas
+ * @code
+ *   uint64_t count = engine_enumerate(engine, 21, print_sum, &data);
+ * @endcode
+ * @param engine estructura de datos
+ * @param value valor a enumerar
+ * @param visitor función que recibe cada suma, en el hilo que invoca
+ * @param data datos que se entregan a visitor
+ * @return uint64_t cantidad de sumas enumeradas, o cero si value es menor
+ *         que seis o mayor que 2^34, o que 2^26 si es impar
+ */
+ENGINE_API uint64_t engine_enumerate(engine_t* engine, uint64_t value,
+                                     engine_visitor_t visitor, void* data);
+
+/**
+ * @brief Calcula la cantidad de sumas de varios valores con thread_count
+ *        hilos
+ * @details Construye una única criba para el mayor valor y calcula del
+ *          valor más caro al más barato, como el modo por lotes del
+ *          programa. Los valores repetidos se calculan una sola vez.
+ * @code
+ *   engine_count_batch(engine, values, value_count, counts);
+ * @endcode
+ * @param engine estructura de datos
+ * @param values valores a calcular
+ * @param value_count cantidad de valores
+ * @param counts cantidad de sumas de cada valor, con el mismo criterio que
+ *        engine_count
+ */
+ENGINE_API void engine_count_batch(engine_t* engine, const uint64_t* values,
+                                   uint32_t value_count, uint64_t* counts);
+
+/**
+ * @brief Destructor, libera la memoria de la estructura
+ * @details No destruye el caché ni la tabla recibidos en
+ *          engine_create_shared
+ * @code
+ *   engine_destroy(engine);
+ * @endcode
+ * @param engine estructura de datos
+ */
+ENGINE_API void engine_destroy(engine_t* engine);
+
+#endif  // !ENGINE_H
@@ -0,0 +1,162 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef ENGINE_INTERNAL_H
+#define ENGINE_INTERNAL_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <omp.h>
+#include "arena.h"
+#include "sieve.h"
+#include "count_table.h"
+#include "engine.h"
+#include "goldbach.h"
+#include "pool.h"
+#include "result_cache.h"
+#include "stats.h"
+
+/// Límite de la primera criba, las siguientes duplican el anterior
+#define ENGINE_MIN_SIEVE_LIMIT (1u << 16)
+/// Cantidad de cribas necesarias para llegar a SIEVE_MAX_LIMIT
+#define ENGINE_SIEVE_COUNT 15
+
+/// Entrada de un lote con su costo estimado, para ordenar el cálculo
+typedef struct engine_task {
+  uint64_t cost;
+  uint64_t value;
+  uint32_t index;
+} engine_task_t;
+
+/**
+ * @brief Constructor que comparte el caché, la tabla y el pool del programa
+ * @details Es el que usan los modos por lotes y por flujo y el servidor, la
+ *          biblioteca solo ofrece engine_create
+ * @code
+ *   engine_t* engine = engine_create_shared(8, cache, NULL, NULL);
+ * @endcode
+ * @param thread_count cantidad de hilos de cálculo, o cero para usar todos
+ *        los procesadores
+ * @param cache caché de resultados compartido, debe existir hasta que se
+ *        destruya la estructura, o NULL para crear uno propio
+ * @param table tabla precalculada de cantidades de sumas, debe existir
+ *        hasta que se destruya la estructura, puede ser NULL
+ * @param pool pool de robo de trabajo con el que se reparten los lotes,
+ *        debe existir hasta que se destruya la estructura, o NULL para
+ *        repartirlos con OpenMP
+ * @return engine_t* estructura de datos
+ */
+engine_t* engine_create_shared(uint32_t thread_count, result_cache_t* cache,
+                               count_table_t* table, pool_t* pool);
+
+/**
+ * @brief Retorna la cantidad de hilos de cálculo
+ * @code
+ *   uint32_t thread_count = engine_get_thread_count(engine);
+ * @endcode
+ * @param engine estructura de datos
+ * @return uint32_t cantidad de hilos, al menos uno
+ */
+uint32_t engine_get_thread_count(engine_t* engine);
+
+/**
+ * @brief Retorna el caché de resultados con el que se calculan las entradas
+ * @code
+ *   result_cache_t* cache = engine_get_cache(engine);
+ * @endcode
+ * @param engine estructura de datos
+ * @return result_cache_t* caché compartido o propio
+ */
+result_cache_t* engine_get_cache(engine_t* engine);
+
+/**
+ * @brief Retorna la tabla de cantidades de sumas
+ * @code
+ *   count_table_t* table = engine_get_table(engine);
+ * @endcode
+ * @param engine estructura de datos
+ * @return count_table_t* tabla recibida en engine_create_shared, o NULL
+ */
+count_table_t* engine_get_table(engine_t* engine);
+
+/**
+ * @brief Retorna el pool con el que se reparten los lotes
+ * @code
+ *   pool_t* pool = engine_get_pool(engine);
+ * @endcode
+ * @param engine estructura de datos
+ * @return pool_t* pool recibido en engine_create_shared, o NULL
+ */
+pool_t* engine_get_pool(engine_t* engine);
+
+/**
+ * @brief Retorna la criba con la que se debe calcular la entrada
+ * @details Las entradas que responde la tabla no requieren una criba mayor,
+ *          salvo si listan sus sumas
+ * @code
+ *   sieve_t* sieve = engine_get_sieve(engine, goldbach);
+ * @endcode
+ * @param engine estructura de datos
+ * @param goldbach entrada a calcular
+ * @return sieve_t* criba con límite mayor o igual al valor de la entrada o
+ *         SIEVE_MAX_LIMIT
+ */
+sieve_t* engine_get_sieve(engine_t* engine, goldbach_t* goldbach);
+
+/**
+ * @brief Retorna la criba con la que se debe calcular un lote
+ * @details Si ninguna criba existente abarca el mayor valor del lote que la
+ *          tabla no responde, la crea con el tamaño exacto de ese valor en
+ *          lugar de duplicar el límite, pues el lote se conoce completo
+ * @code
+ *   sieve_t* sieve = engine_get_batch_sieve(engine, entries, count);
+ * @endcode
+ * @param engine estructura de datos
+ * @param entries entradas del lote
+ * @param entry_count cantidad de entradas
+ * @return sieve_t* criba con límite mayor o igual al mayor valor o
+ *         SIEVE_MAX_LIMIT
+ */
+sieve_t* engine_get_batch_sieve(engine_t* engine, goldbach_t** entries,
+                                uint32_t entry_count);
+
+/**
+ * @brief Calcula un lote de entradas de la más cara a la más barata
+ * @details Obtiene la criba del lote, construye una tabla por convolución
+ *          si resulta más barata y no hay una precalculada, ordena las
+ *          entradas con engine_schedule y las calcula con result_cache_run,
+ *          repartiéndolas con el pool si se indicó uno o con un ciclo
+ *          dinámico de OpenMP. Con mediciones suma el tiempo de cada fase y
+ *          el de cada entrada al hilo que la calcula.
+ * @code
+ *   engine_compute(engine, entries, count, stats);
+ * @endcode
+ * @param engine estructura de datos
+ * @param entries entradas del lote, conservan su resultado
+ * @param entry_count cantidad de entradas
+ * @param stats mediciones de la corrida, puede ser NULL
+ */
+void engine_compute(engine_t* engine, goldbach_t** entries,
+                    uint32_t entry_count, stats_t* stats);
+
+/**
+ * @brief Compara dos tareas de un lote para qsort
+ * @details Ordena por costo descendente y desempata por valor y por
+ *          posición, de forma que las repeticiones de un valor quedan
+ *          contiguas
+ * @code
+ *   qsort(tasks, count, sizeof(engine_task_t), engine_compare_tasks);
+ * @endcode
+ * @param left primera tarea
+ * @param right segunda tarea
+ * @return int negativo, cero o positivo según el orden de left y right
+ */
+int engine_compare_tasks(const void* left, const void* right);
+
+#endif  // !ENGINE_INTERNAL_H
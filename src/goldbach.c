@@ -4,365 +4,723 @@
 
 #include "goldbach.h"
 
+/// Consultas a la criba que cuesta en promedio probar un primo con Miller-Rabin
+#define GOLDBACH_PRIMALITY_TEST_COST 32
+/// Menor valor impar cuyos trios se reparten en tareas entre los hilos
+#define GOLDBACH_PARALLEL_WEAK_MIN (1u << 14)
+/// Cantidad de tareas en que se divide el primer primo de un valor grande
+#define GOLDBACH_TASK_COUNT 64
+
+/// Los primos de la criba deben llegar hasta la raíz del mayor valor
+_Static_assert(GOLDBACH_MAX_VALUE
+               <= (uint64_t) SIEVE_MAX_LIMIT * SIEVE_MAX_LIMIT,
+               "GOLDBACH_MAX_VALUE exceeds the square of SIEVE_MAX_LIMIT");
+
 typedef struct goldbach {
   bool is_valid;
+  bool is_too_large;
   bool is_negative;
   bool is_even_number;
-  uint32_t value;
-  uint32_t count;
+  uint64_t value;
+  uint64_t count;
   array_char_t entry;
-  array_uint32_t prime_numbers;
-  array_uint32_t sums;
+  arena_t* arena;
 } goldbach_t;
 
+/// Datos de las tareas en que split_sums divide el primer primo
+typedef struct goldbach_split {
+  uint64_t number;
+  bool even_number;
+  uint64_t maximum;
+  uint64_t width;
+  sieve_t* sieve;
+  stats_t* stats;
+  uint64_t counts[GOLDBACH_TASK_COUNT];
+} goldbach_split_t;
+
+/**
+ * @brief Receptor de las sumas que encuentran los recorridos de la criba
+ * @details Los recorridos reciben NULL en su lugar cuando solo cuentan
+ */
+typedef struct sum_sink {
+  goldbach_visitor_t visitor;
+  void* data;
+} sum_sink_t;
+
+/**
+ * @brief Datos de print_sum para escribir las sumas de una entrada
+ */
+typedef struct sum_printer {
+  writer_t* writer;
+  uint64_t count;
+} sum_printer_t;
+
 /**
- * @brief Valida la entrada
- * @details Revisa que la entrada proporcionada sea un caracter válido
+ * @brief Valida la entrada y extrae su valor en una sola pasada
+ * @details Revisa que la entrada sea un "-" opcional seguido de dígitos y
+ *          los convierte a uint64_t a la vez, para que pueda ser usado en
+ *          posteriores cálculos con mayor facilidad. Si el valor no cabe en
+ *          64 bits se satura a UINT64_MAX. Llena los campos is_valid, value,
+ *          is_negative e is_even_number de la estructura.
  * @code
- *   bool is_valid = valdiate_value("-21");
+ *   parse_entry(goldbach, "-21", 3);
+ *   //goldbach -> value vale 21 y goldbach -> is_negative vale true
  * @endcode
- * @param entry cadena de caracteres
- * @return 
- *   true: si la entrada es válida
- *   false: si la entrada es inválida
+ * @param goldbach estructura de datos
+ * @param entry caracteres de la entrada, sin terminar en nulo
+ * @param length cantidad de caracteres de la entrada
  */
-bool validate_value(char* entry);
+void parse_entry(goldbach_t* goldbach, const char* entry, uint32_t length);
 
 /**
- * @brief Valida si la entrada es o no un valor negativo
- * @details Revisa que la cadena de entrada contenga "-" en la posición 0 
- *          del arreglo de caracteres
+ * @brief Retorna la cantidad de Sumas de Goldbach fuertes sin guardarlas
+ * @details Recorre los mismos primos que goldbach_enumerate pero solo
+ *          acumula la cantidad de parejas encontradas
  * @code
- *   bool is_negative = valdiate_negative("-21");
+ *   uint64_t count = count_strong_sums(10, sieve);
+ *   //Retorna: 2, correspondiente a [3, 7] y [5, 5]
  * @endcode
- * @param entry cadena de caracteres 
- * @return
- *   true: si entry[0] == '-'
- *   false: si si entry[0] != '-'
+ * @param number número resultado de las Sumas de Goldbach
+ * @param sieve criba compartida con los números primos hasta al menos number
+ * @return uint64_t cantidad de Sumas de Goldbach
  */
-bool validate_negative(char* entry);
+uint64_t count_strong_sums(uint64_t number, sieve_t* sieve);
 
 /**
- * @brief Valida si la entrada corresponde a un número par o no
+ * @brief Retorna la cantidad de Sumas de Goldbach débiles sin guardarlas
+ * @details Recorre los mismos primos que goldbach_enumerate pero solo
+ *          acumula la cantidad de trios encontrados
  * @code
- *   bool even_number = valdiate_even_number("10");
+ *   uint64_t count = count_weak_sums(9, sieve);
+ *   //Retorna: 2, correspondiente a [2, 2, 5] y [3, 3, 3]
  * @endcode
- * @param entry cadena de caracteres 
- * @return 
- *   true: si el número es par
- *   false: si el número es impar  
+ * @param number número resultado de las Sumas de Goldbach
+ * @param sieve criba compartida con los números primos hasta al menos number
+ * @return uint64_t cantidad de Sumas de Goldbach
  */
-bool validate_even_number(char* entry);
+uint64_t count_weak_sums(uint64_t number, sieve_t* sieve);
 
 /**
- * @brief Valida que un número sea primo
+ * @brief Determina si invocar y retornar count_weak_sums o count_strong_sums
  * @code
- *   bool is_prime = validate_is_prime(7);
+ *   uint64_t count = count_sums(12, true, sieve);
  * @endcode
- * @param number número a validar
- * @return 
- *   true: si el número es primo
- *   false: si el número no es primo 
+ * @param number número a calcularle las Sumas de Goldbach
+ * @param even_number booleano que indica si number es par o impar
+ * @param sieve criba compartida con los números primos hasta al menos number
+ * @return uint64_t cantidad de Sumas de Goldbach
  */
-bool validate_is_prime(uint32_t number);
+uint64_t count_sums(uint64_t number, bool even_number, sieve_t* sieve);
 
 /**
- * @brief Extrae el valor proporcionado en la enterada
- * @details Convierte la entrada que es char* a uint32_t si es un valor válido para que 
- *          pueda ser usado en posteriores calculos con mayor facilidad.
+ * @brief Retorna en cuántas tareas split_sums divide el primer primo
+ * @details Solo se reparten los valores costosos y dentro de una región
+ *          paralela o de un hilo de pool_t con otros hilos. Los pares solo
+ *          se reparten si exceden a la criba, pues dentro de ella el AND de
+ *          los mapas de bits los cuenta en microsegundos y las tareas solo
+ *          agregarían costo.
  * @code
- *   uint32_t value = extract_value("-317");
+ *   uint32_t task_count = count_tasks(100000000, true, sieve);
  * @endcode
- * @param entry cadena de caracteres 
- * @return uint32_t contenido de la entrada convertido a entero positivo de 64 bits
+ * @param number número resultado de las Sumas de Goldbach
+ * @param even_number booleano que indica si number es par o impar
+ * @param sieve criba compartida con los números primos hasta al menos number
+ * @return uint32_t GOLDBACH_TASK_COUNT si conviene repartirlo, si no uno
  */
-uint32_t extract_value(char* entry);
+uint32_t count_tasks(uint64_t number, bool even_number, sieve_t* sieve);
 
 /**
- * @brief Retorna arreglo con números primos
- * @details Crea un arreglo de uint32_t que genera todos los números primos desde el dos
- *          hasta el número proporcionado por parámetro. Este algoritmo es fuerza bruta.
+ * @brief Cuenta las Sumas de Goldbach de number repartiendo el primer primo
+ *        entre los hilos del equipo de OpenMP o del pool
+ * @details El rango del primer primo, q para los pares y p para los impares,
+ *          se divide en task_count tareas contiguas que los hilos
+ *          desocupados toman al terminar sus propias entradas, y al final se
+ *          suman sus cantidades. Dentro de un hilo de pool_t las tareas se
+ *          crean con pool_spawn y si no con un taskloop de OpenMP.
  * @code
- *   uint32_t* primes = generate_prime_numbers(10);
- *   //Retorna: [2, 3, 5, 7] para el caso de 10
+ *   uint64_t count = split_sums(100000000, true, sieve, 64);
  * @endcode
- * @param number número hasta el cual se generan primos    
- * @return array_uint32_t arreglo con números primos
+ * @param number número resultado de las Sumas de Goldbach
+ * @param even_number booleano que indica si number es par o impar
+ * @param sieve criba compartida con los números primos hasta al menos number
+ * @param task_count cantidad de tareas, de count_tasks
+ * @return uint64_t cantidad de Sumas de Goldbach
  */
-array_uint32_t generate_prime_numbers(uint32_t number);
+uint64_t split_sums(uint64_t number, bool even_number, sieve_t* sieve,
+                    uint32_t task_count);
 
 /**
- * @brief Retorna arreglo con Sumas de Goldbach válidas para el valor de la estructura
- * @details Al detectarse una combinación de dos valores ambos se agregan al arreglo, le 
- *          corresponderá a otro método separar los elementos del arreglo en las determinadas 
- *          parejas de números que forman la Suma de Goldbach
+ * @brief Cuenta las sumas de una de las tareas de split_sums
+ * @details Es el cuerpo del taskloop y la tarea de pool_t, guarda la
+ *          cantidad en counts[task]. Si la entrada se mide y el hilo no está
+ *          midiendo una propia, suma a ese hilo el tiempo y los contadores de
+ *          la tarea, que de otro modo no aparecerían en ninguna entrada.
  * @code
- *   uint32_t* weak_sums = generate_weak_sums(12, prime_numbers);
- *   //Con goldbach -> value = 10 retorna [3, 7, 5, 5], este arreglo corresponde a resultados
- *   //[3, 7] y [5, 5]
+ *   find_task(&split, task, omp_get_thread_num());
  * @endcode
- * @param number número resultado de las Sumas de Goldbach
- * @param prime_numbers arreglo con números primos desde dos hasta el number
- * @return array_uint32_t elementos de las soluciones de Sumas de Goldbach
+ * @param data estructura goldbach_split_t
+ * @param task número de la tarea, que indica el rango del primer primo
+ * @param thread número del hilo que la ejecuta en el pool o en el equipo
  */
-array_uint32_t generate_strong_sums(uint32_t number,
-                                    array_uint32_t prime_numbers);
+void find_task(void* data, uint32_t task, uint32_t thread);
 
 /**
- * @brief Retorna arreglo con Sumas de Goldbach válidas para el valor de la estructura
- * @details Al detectarse una conbinación de tres valores ambos se agregan al arreglo, le 
- *          corresponderá a otro separar los elementos del arreglo en los determinados 
- *          trios de números que forman la Suma de Goldbach
+ * @brief Busca las Sumas de Goldbach de number cuyo primer primo está entre
+ *        minimum y maximum
+ * @details Invoca find_pairs si even_number es true y si no find_triples
  * @code
- *   uint32_t* strong_sums = generate_strong_sums(15, prime_numbers);
- *   //Con goldbach -> value = 9 retorna [3,3,3], este arreglo corresponde a resultados
- *   //[3,3,3]
+ *   uint64_t count = find_sums(12, true, 2, 6, sieve, NULL);
  * @endcode
  * @param number número resultado de las Sumas de Goldbach
- * @param prime_numbers arreglo con números primos desde dos hasta el number
- * @return array_uint32_t elementos de las soluciones de Sumas de Goldbach
+ * @param even_number booleano que indica si number es par o impar
+ * @param minimum menor valor admitido para el primer primo
+ * @param maximum mayor valor admitido para el primer primo
+ * @param sieve criba compartida con los números primos hasta al menos number
+ * @param sink receptor de las sumas, o NULL para solo contarlas
+ * @return uint64_t cantidad de Sumas de Goldbach
  */
-array_uint32_t generate_weak_sums(uint32_t number,
-                                  array_uint32_t prime_numbers);
+uint64_t find_sums(uint64_t number, bool even_number, uint64_t minimum,
+                   uint64_t maximum, sieve_t* sieve, sum_sink_t* sink);
 
 /**
- * @brief Determina si invocar y retornar generate_weak_sums o generate_strong_sums
- * @details Determina cual método usar basandose en si even_number es true o false
+ * @brief Busca los trios de primos p <= q <= r tales que p + q + r = number
+ *        y minimum <= p <= maximum
+ * @details Fija el primer primo p y busca con find_pairs las parejas q <= r
+ *          de number - p con q >= p, por lo que los trios se entregan a sink
+ *          en orden ascendente
  * @code
- *   uint32_t* sums = generate_sums(12, true, prime_numbers);
+ *   uint64_t count = find_triples(9, 2, 3, sieve, &sink);
+ *   //Retorna: 2, y entrega [2, 2, 5] y [3, 3, 3] a sink
  * @endcode
- * @param number número a calcularle las Sumas de Goldbach
- * @param even_number booleano que indica si number es par o impar
- * @param prime_numbers arreglo con números primos desde dos hasta el number
- * @return array_uint32_t elementos de las soluciones de Sumas de Goldbach 
+ * @param number número impar resultado de los trios
+ * @param minimum menor valor admitido para p
+ * @param maximum mayor valor admitido para p, a lo sumo number / 3
+ * @param sieve criba compartida con los números primos hasta al menos number
+ * @param sink receptor de los trios, o NULL para solo contarlos
+ * @return uint64_t cantidad de trios encontrados
  */
-array_uint32_t generate_sums(uint32_t number, bool even_number,
-                             array_uint32_t prime_numbers);
+uint64_t find_triples(uint64_t number, uint64_t minimum, uint64_t maximum,
+                      sieve_t* sieve, sum_sink_t* sink);
 
 /**
- * @brief Retorna la cantidad de sumas de Goldabch para el value dado
- * @details Para encontrar la cantidad de soluciones se divide la cantidad de elementos
- *          del arreglo entre dos si even_number es true y entre tres si even_number es
- *          false
+ * @brief Busca las parejas de primos q <= r tales que q + r = number y
+ *        minimum <= q <= maximum
+ * @details Si number está dentro de la criba se recorren sus primos a
+ *          partir de minimum y se consulta si number - q es primo. Si la
+ *          excede, los números impares solo admiten la pareja
+ *          [2, number - 2] y para los pares se criban por segmentos a la vez
+ *          los candidatos q y sus compañeros number - q, salvo que haya tan
+ *          pocos candidatos que convenga probarlos con Miller-Rabin. Las
+ *          parejas se entregan a sink en orden ascendente de q, precedidas de
+ *          prefix si es distinto de cero.
  * @code
- *   uint32_t count = generate_count(true, sums);
+ *   uint64_t count = find_pairs(10, 2, 5, 0, sieve, &sink);
+ *   //Retorna: 2, y entrega [3, 7] y [5, 5] a sink
  * @endcode
- * @param even_number booleano que indica si número es par o impar
- * @param sums arreglo con las soluciones a las Sumas de Goldbach 
- * @return uint32_t cantidad de Sumas de Goldbach 
+ * @param number número resultado de las parejas
+ * @param minimum menor valor admitido para q
+ * @param maximum mayor valor admitido para q, a lo sumo number / 2
+ * @param prefix primo a agregar antes de cada pareja, o cero para omitirlo
+ * @param sieve criba compartida con los números primos hasta al menos number o
+ *        hasta SIEVE_MAX_LIMIT
+ * @param sink receptor de las parejas, o NULL para solo contarlas
+ * @return uint64_t cantidad de parejas encontradas
  */
-uint32_t generate_count(bool even_number, array_uint32_t sums);
-
-goldbach_t* goldbach_create(char* entry) {
-  // Crear e inicializar campos de la estructura
-  goldbach_t* goldbach = (goldbach_t*) calloc(1, sizeof(goldbach_t));
-  array_char_init(&goldbach -> entry);
-  for (uint32_t index = 0; entry[index]; ++index)
-    array_char_add(&goldbach -> entry, entry[index]);
+uint64_t find_pairs(uint64_t number, uint64_t minimum, uint64_t maximum,
+                    uint64_t prefix, sieve_t* sieve, sum_sink_t* sink);
+
+/**
+ * @brief Busca las parejas de find_pairs cribando por segmentos
+ * @details Criba cada segmento de candidatos impares q junto con el
+ *          segmento reflejado de sus compañeros number - q, de forma que ambos
+ *          se validan con una consulta a memoria sin importar cuánto excedan a
+ *          la criba
+ * @code
+ *   uint64_t count = find_segmented_pairs(10000000000, 3, 5000000000, 0,
+ *                                         sieve, NULL);
+ * @endcode
+ * @param number número par resultado de las parejas
+ * @param minimum menor valor admitido para q, mayor que dos
+ * @param maximum mayor valor admitido para q, a lo sumo number / 2
+ * @param prefix primo a agregar antes de cada pareja, o cero para omitirlo
+ * @param sieve criba compartida con los primos hasta la raíz de number
+ * @param sink receptor de las parejas, o NULL para solo contarlas
+ * @return uint64_t cantidad de parejas encontradas
+ */
+uint64_t find_segmented_pairs(uint64_t number, uint64_t minimum,
+                              uint64_t maximum, uint64_t prefix,
+                              sieve_t* sieve, sum_sink_t* sink);
+
+/**
+ * @brief Entrega una suma a sink, precedida de prefix si es distinto de cero
+ * @code
+ *   add_sum(&sink, 3, 5, 11);
+ *   //Entrega [3, 5, 11] a sink
+ * @endcode
+ * @param sink receptor de las Sumas de Goldbach
+ * @param prefix primer primo de la suma, o cero si es una pareja
+ * @param first primo menor de la pareja
+ * @param second primo mayor de la pareja
+ */
+void add_sum(sum_sink_t* sink, uint64_t prefix, uint64_t first,
+             uint64_t second);
+
+/**
+ * @brief Escribe una suma enumerada por goldbach_print, separada de la
+ *        anterior por una coma
+ * @code
+ *   print_sum(&printer, addends, 2);
+ * @endcode
+ * @param data sum_printer_t con el búfer de salida
+ * @param addends sumandos de la suma
+ * @param count cantidad de sumandos
+ */
+void print_sum(void* data, const uint64_t* addends, uint32_t count);
+
+/**
+ * @brief Estima el costo en consultas a la criba de contar con
+ *        find_pairs(number, 2, number / 2)
+ * @details Dentro de la criba recorre number / 480 palabras de la rueda con
+ *          sieve_count_pairs. Fuera de ella es la cantidad de bits cribados
+ *          en los segmentos.
+ * @code
+ *   uint64_t cost = estimate_pairs_cost(1000000, sieve);
+ * @endcode
+ * @param number número resultado de las parejas
+ * @param sieve criba compartida
+ * @return uint64_t costo estimado
+ */
+uint64_t estimate_pairs_cost(uint64_t number, sieve_t* sieve);
+
+/**
+ * @brief Estima la cantidad de primos menores o iguales a number
+ * @details Dentro de la criba la cuenta es exacta y fuera de ella se
+ *          aproxima con number / ln(number)
+ * @code
+ *   uint64_t count = estimate_prime_count(1000, sieve);
+ *   //Retorna: 168
+ * @endcode
+ * @param number límite de los primos a contar
+ * @param sieve criba compartida
+ * @return uint64_t cantidad estimada de primos
+ */
+uint64_t estimate_prime_count(uint64_t number, sieve_t* sieve);
+
+/**
+ * @brief Retorna la raíz cuadrada entera de number
+ * @code
+ *   uint64_t root = integer_root(99);
+ *   //Retorna: 9
+ * @endcode
+ * @param number número a calcularle la raíz
+ * @return uint64_t mayor entero cuyo cuadrado no excede a number
+ */
+uint64_t integer_root(uint64_t number);
+
+goldbach_t* goldbach_create(const char* entry, uint32_t length,
+                            arena_t* arena) {
+  // Crear e inicializar campos de la estructura, en el arena si se indicó
+  goldbach_t* goldbach = arena
+      ? (goldbach_t*) arena_allocate(arena, sizeof(goldbach_t))
+      : (goldbach_t*) calloc(1, sizeof(goldbach_t));
+  goldbach -> arena = arena;
+  array_char_init(&goldbach -> entry, arena);
+  array_char_add_elements(&goldbach -> entry, entry, length);
   goldbach -> count = 0;
-  goldbach -> is_valid = validate_value(entry);
-  array_uint32_init(&goldbach -> prime_numbers);
-  array_uint32_init(&goldbach -> sums);
-  // Hacer validaciones genrales
-  if (goldbach -> is_valid) {
-    goldbach -> value = extract_value(entry);
-    goldbach -> is_negative = validate_negative(entry);
-    goldbach -> is_even_number = validate_even_number(entry);
-  }
+  // Hacer validaciones generales
+  parse_entry(goldbach, entry, length);
+  /* Los valores que exceden al máximo admitido no se calculan, pero se
+     distinguen de las entradas inválidas al imprimirse */
+  goldbach -> is_too_large = goldbach -> is_valid &&
+      goldbach -> value > (goldbach -> is_even_number ? GOLDBACH_MAX_VALUE
+                                                      : GOLDBACH_MAX_ODD_VALUE);
+  if (goldbach -> is_too_large)
+    goldbach -> is_valid = false;
   return goldbach;
 }
 
-void goldbach_run(goldbach_t* goldbach) {
+goldbach_t* goldbach_create_value(uint64_t value, bool is_negative,
+                                  arena_t* arena) {
+  // Escribir los dígitos de derecha a izquierda, seguidos del signo
+  char text[24];
+  uint32_t start = sizeof(text);
+  do {
+    text[--start] = (char) ('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  if (is_negative)
+    text[--start] = '-';
+  return goldbach_create(text + start, sizeof(text) - start, arena);
+}
+
+void goldbach_run(goldbach_t* goldbach, sieve_t* sieve, count_table_t* table) {
   assert(goldbach);
-  // Si la entrada es válida calcular los números primos y Sumas de Goldbach
-  if (goldbach -> is_valid) {
-    goldbach -> prime_numbers = generate_prime_numbers(goldbach -> value);
-    goldbach -> sums = generate_sums(goldbach -> value,
-                                     goldbach -> is_even_number,
-                                     goldbach -> prime_numbers);
-    goldbach -> count = generate_count(goldbach -> is_even_number,
-                                       goldbach -> sums);
+  assert(sieve);
+  /* Si la entrada es válida y mayor que cinco contar las Sumas de Goldbach
+     con los números primos de la criba compartida, las entradas negativas
+     las enumeran al imprimirse */
+  if (goldbach -> is_valid && goldbach -> value > 5 &&
+      (!table || !count_table_get_count(table, goldbach -> value,
+                  goldbach -> is_even_number, &goldbach -> count))) {
+    goldbach -> count = count_sums(goldbach -> value,
+                                   goldbach -> is_even_number, sieve);
   }
 }
 
-void goldbach_print(goldbach_t* goldbach) {
+uint64_t goldbach_get_value(goldbach_t* goldbach) {
+  assert(goldbach);
+  // Retornar campo value de goldbach si la entrada es válida
+  return goldbach -> is_valid ? goldbach -> value : 0;
+}
+
+uint64_t goldbach_get_count(goldbach_t* goldbach) {
+  assert(goldbach);
+  return goldbach -> count;  // Retornar campo count de goldbach
+}
+
+void goldbach_share_result(goldbach_t* goldbach, uint64_t count) {
+  assert(goldbach);
+  // Tomar el resultado calculado por otra entrada con el mismo valor
+  goldbach -> count = count;
+}
+
+uint64_t goldbach_enumerate(goldbach_t* goldbach, sieve_t* sieve,
+                            goldbach_visitor_t visitor, void* data) {
   assert(goldbach);
-  uint32_t entry_size = array_char_get_count(&goldbach -> entry);
-  char* entry = array_char_get_elements(&goldbach -> entry);
+  assert(sieve);
+  assert(visitor);
+  if (!goldbach -> is_valid || goldbach -> value <= 5)
+    return 0;
+  uint64_t value = goldbach -> value;
+  bool even_number = goldbach -> is_even_number;
+  /* Recorrer en orden el rango completo del primer primo, entregando cada
+     suma a visitor en cuanto se encuentra */
+  sum_sink_t sink = {visitor, data};
+  return find_sums(value, even_number, 2, even_number ? value / 2 : value / 3,
+                   sieve, &sink);
+}
+
+uint64_t goldbach_estimate_cost(goldbach_t* goldbach, sieve_t* sieve,
+                                count_table_t* table) {
+  assert(goldbach);
+  assert(sieve);
+  uint64_t value = goldbach -> value;
+  // Las entradas que no se calculan cuestan una consulta
+  if (!goldbach -> is_valid || value <= 5 || (table &&
+      count_table_has_count(table, value, goldbach -> is_even_number)))
+    return 1;
+  uint64_t cost = estimate_pairs_cost(value, sieve);
+  /* Las sumas débiles buscan las parejas de number - p para cada primo
+     p <= number / 3, cuyo rango decrece hasta cero */
+  if (!goldbach -> is_even_number &&
+      __builtin_mul_overflow(cost, estimate_prime_count(value / 3, sieve) / 2
+                             + 1, &cost))
+    cost = UINT64_MAX;
+  return cost + (cost == 0);
+}
+
+bool goldbach_is_listed(goldbach_t* goldbach) {
+  assert(goldbach);
+  // Solo las entradas válidas y negativas listan sus sumas
+  return goldbach -> is_valid && goldbach -> is_negative;
+}
+
+void goldbach_print(goldbach_t* goldbach, sieve_t* sieve, writer_t* writer) {
+  assert(goldbach);
+  assert(writer);
   // Imprimir las Sumas de Goldbach con el formato indicado según validaciones
-  for (uint32_t index = 0; index < entry_size; ++index)
-    printf("%c", entry[index]);
-  printf(": ");
-  uint32_t* current_sums = array_uint32_get_elements(&goldbach -> sums);
+  writer_put_string(writer, array_char_get_elements(&goldbach -> entry),
+                    array_char_get_count(&goldbach -> entry));
+  writer_put_text(writer, ": ");
   if (goldbach -> is_valid) {
     if (goldbach -> count != 0) {
-      printf("%" PRIu32 " sums", goldbach -> count);
+      writer_put_uint64(writer, goldbach -> count);
+      writer_put_text(writer, " sums");
       if (goldbach -> is_negative) {
-        printf(": ");
-        uint32_t count = array_uint32_get_count(&goldbach -> sums);
-        if (goldbach -> is_even_number) {
-          for (uint32_t index = 1; index < count; index += 2) {
-            printf("%" PRIu32 " + ", current_sums[index - 1]);
-            printf("%" PRIu32, current_sums[index]);
-            if (index + 1 != count)
-              printf(", ");
-          }
-        } else {
-          for (uint32_t index = 2; index < count; index += 3) {
-            printf("%" PRIu32 " + ", current_sums[index - 2]);
-            printf("%" PRIu32 " + ", current_sums[index - 1]);
-            printf("%" PRIu32, current_sums[index]);
-            if (index + 1 != count)
-              printf(", ");
-          }
-        }
+        writer_put_text(writer, ": ");
+        // Escribir cada suma en cuanto se encuentra, sin guardarlas
+        sum_printer_t printer = {writer, 0};
+        goldbach_enumerate(goldbach, sieve, print_sum, &printer);
+        assert(printer.count == goldbach -> count);
       }
     } else {
-      printf("NA");
+      writer_put_text(writer, "NA");
     }
+  } else if (goldbach -> is_too_large) {
+    writer_put_text(writer, "VALUE IS TOO LARGE");
   } else {
-    printf("VALUE IS NOT VALID");
+    writer_put_text(writer, "VALUE IS NOT VALID");
   }
-  printf("\n");
+  writer_put_char(writer, '\n');
 }
 
 void goldbach_destroy(goldbach_t* goldbach) {
   assert(goldbach);
-  // Liberar memoria empleada por la estructura
+  /* Liberar memoria empleada por la estructura, la del arena se libera
+     junto con él */
   array_char_destroy(&goldbach -> entry);
-  array_uint32_destroy(&goldbach -> prime_numbers);
-  array_uint32_destroy(&goldbach -> sums);
-  free(goldbach);
+  if (!goldbach -> arena)
+    free(goldbach);
 }
 
-bool validate_value(char* entry) {
-  bool answer = true;
-  /* Recorrer cada campo de la entrada verificando que no existan dígitos 
-     inválidos */
-  if (entry[0] == '-') {
-    for (uint32_t index = 1; entry[index] && answer; ++index) {
-      if (!isdigit(entry[index]))
-        answer = false;
-    }
-  } else {
-    for (uint32_t index = 0; entry[index] && answer; ++index) {
-      if (!isdigit(entry[index]))
-        answer = false;
+void parse_entry(goldbach_t* goldbach, const char* entry, uint32_t length) {
+  bool is_negative = length != 0 && entry[0] == '-';
+  bool is_valid = true;
+  uint64_t value = 0;
+  /* Recorrer cada campo de la entrada verificando que no existan dígitos
+     inválidos y convertirla a la vez, saturando si se desborda */
+  for (uint32_t index = is_negative; index < length; ++index) {
+    uint64_t digit = (uint64_t) ((unsigned char) entry[index] - '0');
+    if (digit > 9) {
+      is_valid = false;
+      break;
     }
+    value = value > (UINT64_MAX - digit) / 10 ? UINT64_MAX
+                                               : 10 * value + digit;
+  }
+  goldbach -> is_valid = is_valid;
+  if (is_valid) {
+    goldbach -> value = value;
+    goldbach -> is_negative = is_negative;
+    goldbach -> is_even_number = value % 2 == 0;
   }
-  return answer;
 }
 
-bool validate_negative(char* entry) {
-  // Averiguar si la entrada es negtiva o no
-  return entry[0] == '-' ? true : false;
+uint64_t count_sums(uint64_t number, bool even_number, sieve_t* sieve) {
+  /* Si even_number es true retornar count_strong_sums si no retornar
+     count_weak_sums */
+  return even_number ? count_strong_sums(number, sieve)
+                     : count_weak_sums(number, sieve);
 }
 
-bool validate_even_number(char* entry) {
-  bool answer = false;
-  uint32_t value = extract_value(entry);
-  // Averiguar si la entrada es un número par o impar
-  if (value %2 == 0)
-    answer = true;
-  return answer;
+uint64_t count_strong_sums(uint64_t number, sieve_t* sieve) {
+  // Contar los primos p <= number / 2 cuyo compañero number - p es primo
+  return split_sums(number, true, sieve, count_tasks(number, true, sieve));
 }
 
-bool validate_is_prime(uint32_t number) {
-  if (number == 2 || number == 3)
-    return true;
-  if (number %2 == 0 || number %3 == 0)
-    return false;
-  for (uint32_t index = 5; index * index <= number; index += 6) {
-    if (number %index == 0 || number %(index+2) == 0)
-      return false;
-  }
-  return true;
+uint64_t count_weak_sums(uint64_t number, sieve_t* sieve) {
+  // Contar los trios p <= q <= r con r = number - p - q primo
+  return split_sums(number, false, sieve, count_tasks(number, false, sieve));
 }
 
-uint32_t extract_value(char* entry) {
-  // Convertir entry a entero de 64 bits positivo
-  uint32_t value = (uint32_t) atoi(entry);
-  if (validate_negative(entry))
-    value *= -1;
-  return value;
+uint32_t count_tasks(uint64_t number, bool even_number, sieve_t* sieve) {
+  // Sin otros hilos disponibles no se reparte
+  pool_t* pool = pool_get_current();
+  if ((pool ? pool -> thread_count : (uint32_t) omp_get_num_threads()) == 1)
+    return 1;
+  bool is_costly = even_number ? number > sieve_get_limit(sieve)
+                               : number >= GOLDBACH_PARALLEL_WEAK_MIN;
+  return is_costly ? GOLDBACH_TASK_COUNT : 1;
 }
 
-array_uint32_t generate_prime_numbers(uint32_t number) {
-  array_uint32_t prime_numbers;
-  array_uint32_init(&prime_numbers);
-  if (number > 5) {
-    // Generar números primos desde 2 hasta number y guardarlos en el arreglo
-    for (uint32_t index = 2; index <= number; ++index) {
-      if (validate_is_prime(index))
-        array_uint32_add(&prime_numbers, index);
-    }
+uint64_t split_sums(uint64_t number, bool even_number, sieve_t* sieve,
+                    uint32_t task_count) {
+  uint64_t maximum = even_number ? number / 2 : number / 3;
+  assert(task_count <= GOLDBACH_TASK_COUNT);
+  // Los valores de una sola tarea se buscan sin crearla
+  if (task_count == 1)
+    return find_sums(number, even_number, 2, maximum, sieve, NULL);
+  goldbach_split_t split = {number, even_number, maximum,
+                            (maximum - 2) / task_count + 1, sieve,
+                            stats_get_current(), {0}};
+  // Cada tarea cuenta las sumas de un rango contiguo del primer primo
+  pool_t* pool = pool_get_current();
+  if (pool) {
+    // Los demás hilos del pool roban las tareas de la cola de este hilo
+    pool_group_t group = {0};
+    pool_spawn(pool, &group, task_count, find_task, &split);
+    pool_wait(pool, &group);
+  } else {
+    #pragma omp taskloop grainsize(1) default(none) shared(split, task_count)
+    for (uint32_t task = 0; task < task_count; ++task)
+      find_task(&split, task, (uint32_t) omp_get_thread_num());
   }
-  return prime_numbers;
+  // Sumar las cantidades de todas las tareas
+  uint64_t count = 0;
+  for (uint32_t task = 0; task < task_count; ++task)
+    count += split.counts[task];
+  return count;
 }
 
-array_uint32_t generate_sums(uint32_t number, bool even_number,
-                             array_uint32_t prime_numbers) {
-  /* Si even_number es true retornar generate_strong_sums si no retornar 
-     generate_weak_sums */
-  return even_number ? generate_strong_sums(number, prime_numbers)
-                     : generate_weak_sums(number, prime_numbers);
+void find_task(void* data, uint32_t task, uint32_t thread) {
+  goldbach_split_t* split = (goldbach_split_t*) data;
+  /* Medir solo en los hilos que ayudan sin calcular una entrada propia,
+     pues la medición de esa entrada ya incluye las tareas que ejecuta */
+  bool is_measured = split -> stats && !stats_get_current();
+  stats_mark_t start;
+  if (is_measured)
+    stats_mark(split -> stats, &start);
+  uint64_t first = 2 + task * split -> width;
+  uint64_t last = first + split -> width - 1 < split -> maximum
+                  ? first + split -> width - 1 : split -> maximum;
+  split -> counts[task] = first <= last
+      ? find_sums(split -> number, split -> even_number, first, last,
+                  split -> sieve, NULL)
+      : 0;
+  if (is_measured)
+    stats_add_task(split -> stats, thread, &start, split -> number);
 }
 
-array_uint32_t generate_strong_sums(uint32_t number,
-                                    array_uint32_t prime_numbers) {
-  array_uint32_t sums;
-  array_uint32_init(&sums);
-  uint32_t index_number = 0;
-  uint32_t jindex_number = 0;
-  uint32_t prime_numbers_count = array_uint32_get_count(&prime_numbers);
-  uint32_t* prime_numbers_elements = array_uint32_get_elements(&prime_numbers);
-  // Generar combinaciones de números
-  for (uint32_t index = 0; index < prime_numbers_count; ++index) {
-    index_number = prime_numbers_elements[index];
-    for (uint32_t jindex = index; jindex < prime_numbers_count; ++jindex) {
-      jindex_number = prime_numbers_elements[jindex];
-      /* Si la suma de los números actuales de las repeticiones son iguales al
-         valor y su suma es válida agregar números de recorridos a sums */
-      if (index_number + jindex_number == number) {
-        array_uint32_add(&sums, index_number);
-        array_uint32_add(&sums, jindex_number);
+uint64_t find_sums(uint64_t number, bool even_number, uint64_t minimum,
+                   uint64_t maximum, sieve_t* sieve, sum_sink_t* sink) {
+  /* Si even_number es true retornar find_pairs si no retornar
+     find_triples */
+  return even_number ? find_pairs(number, minimum, maximum, 0, sieve, sink)
+                     : find_triples(number, minimum, maximum, sieve, sink);
+}
+
+uint64_t find_triples(uint64_t number, uint64_t minimum, uint64_t maximum,
+                      sieve_t* sieve, sum_sink_t* sink) {
+  uint64_t count = 0;
+  uint64_t prime = minimum <= 2 ? 2 : sieve_next_prime(sieve, minimum - 1);
+  /* Fijar el primer primo p, los otros dos son las parejas q <= r de
+     number - p con q >= p */
+  for (; prime <= maximum; prime = sieve_next_prime(sieve, prime)) {
+    count += find_pairs(number - prime, prime, (number - prime) / 2,
+                        sink ? prime : 0, sieve, sink);
+  }
+  return count;
+}
+
+uint64_t find_pairs(uint64_t number, uint64_t minimum, uint64_t maximum,
+                    uint64_t prefix, sieve_t* sieve, sum_sink_t* sink) {
+  uint64_t count = 0;
+  if (!sink && number % 2 == 0 && number <= sieve_get_limit(sieve)) {
+    // Contar las parejas con el AND de los mapas de bits de la criba
+    count = sieve_count_pairs(sieve, (uint32_t) number, (uint32_t) minimum,
+                              (uint32_t) maximum);
+  } else if (number <= sieve_get_limit(sieve)) {
+    // Recorrer únicamente los primos de la rueda entre minimum y maximum
+    sieve_iterator_t iterator;
+    sieve_iterator_init(&iterator, sieve, minimum, maximum);
+    uint64_t prime = sieve_iterator_next(&iterator);
+    if (sink) {
+      for (; prime; prime = sieve_iterator_next(&iterator)) {
+        if (sieve_is_prime(sieve, number - prime)) {
+          add_sum(sink, prefix, prime, number - prime);
+          ++count;
+        }
+      }
+    } else {
+      for (; prime; prime = sieve_iterator_next(&iterator))
+        count += sieve_is_prime(sieve, number - prime);
+    }
+  } else if (number % 2 == 1) {
+    // Un número impar solo es suma de dos primos si uno de ellos es 2
+    if (minimum <= 2 && maximum >= 2 && sieve_is_prime(sieve, number - 2)) {
+      if (sink)
+        add_sum(sink, prefix, 2, number - 2);
+      ++count;
+    }
+  } else {
+    /* Un número par mayor que la criba solo admite parejas impares, que se
+       prueban individualmente si son menos que los primos base de un
+       segmento y si no se criban por segmentos */
+    uint64_t first = minimum < 3 ? 3 : minimum | 1;
+    uint64_t last = maximum;
+    uint64_t candidates = first <= last ? (last - first) / 2 + 1 : 0;
+    uint32_t root = (uint32_t) integer_root(number);
+    if (candidates * GOLDBACH_PRIMALITY_TEST_COST <
+        sieve_count_primes(sieve, root)) {
+      for (uint64_t prime = first; prime <= last; prime += 2) {
+        if (sieve_is_prime(sieve, prime) &&
+            sieve_is_prime(sieve, number - prime)) {
+          if (sink)
+            add_sum(sink, prefix, prime, number - prime);
+          ++count;
+        }
       }
+    } else {
+      count = find_segmented_pairs(number, first, last, prefix, sieve, sink);
     }
   }
-  return sums;
+  return count;
 }
 
-array_uint32_t generate_weak_sums(uint32_t number,
-                                  array_uint32_t prime_numbers) {
-  array_uint32_t sums;
-  array_uint32_init(&sums);
-  uint32_t index_number = 0;
-  uint32_t jindex_number = 0;
-  uint32_t kindex_number = 0;
-  uint32_t prime_numbers_count = array_uint32_get_count(&prime_numbers);
-  uint32_t* prime_numbers_elements = array_uint32_get_elements(&prime_numbers);
-  // Generar combinaciones de números
-  for (uint32_t index = 0; index < prime_numbers_count; ++index) {
-    index_number = prime_numbers_elements[index];
-    for (uint32_t jindex = index; jindex < prime_numbers_count; ++jindex) {
-      jindex_number = prime_numbers_elements[jindex];
-      for (uint32_t kindex = jindex; kindex < prime_numbers_count; ++kindex) {
-        kindex_number = prime_numbers_elements[kindex];
-        /* Si la suma de los números actuales de las repeticiones son iguales al
-           valor y su suma es válida agregar números de recorridos a sums */
-        if (index_number + jindex_number + kindex_number == number) {
-          array_uint32_add(&sums, index_number);
-          array_uint32_add(&sums, jindex_number);
-          array_uint32_add(&sums, kindex_number);
+uint64_t find_segmented_pairs(uint64_t number, uint64_t minimum,
+                              uint64_t maximum, uint64_t prefix,
+                              sieve_t* sieve, sum_sink_t* sink) {
+  assert(number % 2 == 0 && minimum > 2);
+  uint64_t count = 0;
+  uint64_t first = minimum | 1;
+  uint64_t last = maximum;
+  segmented_sieve_t lower;
+  segmented_sieve_t upper;
+  segmented_sieve_init(&lower);
+  segmented_sieve_init(&upper);
+  /* Cribar los candidatos q de first a last por segmentos, junto con el
+     segmento reflejado de sus compañeros: el i-ésimo impar de lower se
+     empareja con el (length - 1 - i)-ésimo de upper */
+  while (first <= last) {
+    uint64_t remaining = (last - first) / 2 + 1;
+    uint32_t length = remaining < SEGMENTED_SIEVE_LENGTH
+                      ? (uint32_t) remaining : SEGMENTED_SIEVE_LENGTH;
+    uint64_t end = first + 2 * ((uint64_t) length - 1);
+    segmented_sieve_fill(&lower, first, length, sieve);
+    segmented_sieve_fill(&upper, number - end, length, sieve);
+    // Recorrer solo los bits encendidos de lower en orden ascendente
+    for (uint32_t word = 0; word < (length + 63) / 64; ++word) {
+      uint64_t bits = lower.bits[word];
+      while (bits) {
+        uint32_t index = 64 * word + (uint32_t) __builtin_ctzll(bits);
+        bits &= bits - 1;
+        if (segmented_sieve_is_prime(&upper, length - 1 - index)) {
+          if (sink)
+            add_sum(sink, prefix, first + 2 * (uint64_t) index,
+                    number - first - 2 * (uint64_t) index);
+          ++count;
         }
       }
     }
+    first = end + 2;
   }
-  return sums;
+  segmented_sieve_destroy(&lower);
+  segmented_sieve_destroy(&upper);
+  return count;
 }
 
-uint32_t generate_count(bool even_number, array_uint32_t sums) {
-  // Averiguar la cantidad de sumas encontradas
-  return even_number ? array_uint32_get_count(&sums) / 2
-                     : array_uint32_get_count(&sums) / 3;
+void add_sum(sum_sink_t* sink, uint64_t prefix, uint64_t first,
+             uint64_t second) {
+  // Agregar el prefijo solo en las sumas débiles
+  uint64_t addends[3] = {prefix, first, second};
+  sink -> visitor(sink -> data, addends + !prefix, 3 - !prefix);
+}
+
+void print_sum(void* data, const uint64_t* addends, uint32_t count) {
+  sum_printer_t* printer = (sum_printer_t*) data;
+  writer_t* writer = printer -> writer;
+  // Separar cada suma de la anterior con una coma
+  if (printer -> count++ != 0)
+    writer_put_text(writer, ", ");
+  writer_put_uint64(writer, addends[0]);
+  for (uint32_t addend = 1; addend < count; ++addend) {
+    writer_put_text(writer, " + ");
+    writer_put_uint64(writer, addends[addend]);
+  }
+}
+
+uint64_t estimate_pairs_cost(uint64_t number, sieve_t* sieve) {
+  // Fuera de la criba se criban number / 4 impares y sus compañeros
+  if (number > sieve_get_limit(sieve))
+    return number / 2;
+  return number / 2 / SIEVE_WORD_SPAN + 1;
+}
+
+uint64_t estimate_prime_count(uint64_t number, sieve_t* sieve) {
+  if (number <= sieve_get_limit(sieve))
+    return sieve_count_primes(sieve, (uint32_t) number);
+  // Aproximar ln(number) con log2(number) * ln(2)
+  uint64_t logarithm = 63 - __builtin_clzll(number);
+  return number / (logarithm * 69 / 100 + 1);
+}
+
+uint64_t integer_root(uint64_t number) {
+  uint64_t root = number;
+  uint64_t next = (root + 1) / 2;
+  // Método de Newton, decrece hasta alcanzar la raíz entera
+  while (next < root) {
+    root = next;
+    next = (root + number / root) / 2;
+  }
+  return root;
 }
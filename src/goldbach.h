@@ -5,14 +5,28 @@
 #ifndef GOLDBACH_H
 #define GOLDBACH_H
 #include <stdio.h>
-#include <ctype.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <omp.h>
+#include "arena.h"
 #include "array_char.h"
-#include "array_uint32.h"
+#include "sieve.h"
+#include "count_table.h"
+#include "pool.h"
+#include "segmented_sieve.h"
+#include "stats.h"
+#include "writer.h"
+
+/// Mayor valor par admitido, contar sus parejas crece con el valor y en
+/// 2^34 toma cerca de 40 segundos de un núcleo, en 2^35 pasaría del minuto
+#define GOLDBACH_MAX_VALUE (1ull << 34)
+/// Mayor valor impar admitido, contar sus trios crece con el cuadrado del
+/// valor y en 2^26 toma cerca de 50 segundos de un núcleo, en 2^27 pasaría
+/// de tres minutos
+#define GOLDBACH_MAX_ODD_VALUE (1ull << 26)
 
 /**
  * @brief Estructura de datos que se encarga del cálculo e impresión de
@@ -21,44 +35,181 @@
  *          se le aplican métodos de validación para asignar un valor de 
  *          verdad a los campos is_valid, is_negative y is_even_number.
  *          También se guarda el número entero resultante de transformar 
- *          la cadena de caracteres entry, se almacenan los número primos
- *          correspondientes en un arreglo y se almacenan los valores de
- *          las soluciones de Sumas de Goldbach en otro arreglo.
+ *          la cadena de caracteres entry y la cantidad de soluciones de
+ *          Sumas de Goldbach. Las sumas no se guardan, sino que se enumeran
+ *          con goldbach_enumerate al imprimirlas.
  */
 typedef struct goldbach goldbach_t;
 
+/**
+ * @brief Función que recibe cada suma enumerada por goldbach_enumerate
+ * @code
+ *   void print_sum(void* data, const uint64_t* addends, uint32_t count);
+ * @endcode
+ * @param data datos del receptor indicados a goldbach_enumerate
+ * @param addends sumandos de la suma en orden ascendente
+ * @param count cantidad de sumandos, dos en las sumas fuertes y tres en las
+ *        débiles
+ */
+typedef void (*goldbach_visitor_t)(void* data, const uint64_t* addends,
+                                   uint32_t count);
+
 /**
  * @brief Constructor, inicializa los campos de la estructura y aplica
  *        algunas validaciones
+ * @details Las entradas cuyo valor absoluto excede GOLDBACH_MAX_VALUE,
+ *          o GOLDBACH_MAX_ODD_VALUE si es impar, no se calculan, pues tomarían
+ *          más de un minuto de un núcleo, y se imprimen como demasiado
+ *          grandes en lugar de inválidas. Si se indica un
+ *          arena, la estructura y su entrada se reservan en él y se liberan
+ *          junto con el arena, de forma que un lote de millones de entradas no
+ *          hace una llamada a malloc por cada una.
+ * @code
+ *  goldbach_t* goldbach = goldbach_create("31", 2, NULL);
+ * @endcode
+ * @param entry caracteres a evaluar, no requiere terminar en nulo
+ * @param length cantidad de caracteres de entry
+ * @param arena arena donde se reserva la estructura, o NULL para usar el
+ *        heap
+ * @return goldbach_t* estructura de datos
+ */
+goldbach_t* goldbach_create(const char* entry, uint32_t length,
+                            arena_t* arena);
+
+/**
+ * @brief Constructor a partir de un número en lugar de una cadena
+ * @details La entrada se guarda en decimal, con el signo si is_negative,
+ *          de forma que goldbach_print la escribe como la habría digitado
+ *          el usuario
+ * @code
+ *  goldbach_t* goldbach = goldbach_create_value(21, true, NULL);
+ * @endcode
+ * @param value valor absoluto de la entrada
+ * @param is_negative true para que la entrada liste sus sumas
+ * @param arena arena donde se reserva la estructura, o NULL para usar el
+ *        heap
+ * @return goldbach_t* estructura de datos
+ */
+goldbach_t* goldbach_create_value(uint64_t value, bool is_negative,
+                                  arena_t* arena);
+
+/**
+ * @brief Se invocan los métodos de cálculo de sumas
+ * @details Solo se calcula la cantidad de sumas, incluso en las entradas que
+ *          las listan, pues estas se enumeran al imprimirlas. Los números
+ *          primos se leen de la criba compartida sin copiarlos,
+ *          la cual debe abarcar al menos el valor de la estructura o llegar
+ *          a SIEVE_MAX_LIMIT, en cuyo caso los primos mayores se criban por
+ *          segmentos a partir de ella. Si se proporciona una tabla de
+ *          cantidades y el valor está dentro de ella, la cantidad se toma
+ *          de la tabla sin calcularla.
+ * @code
+ *  goldbach_run(goldbach, sieve, NULL);
+ * @endcode
+ * @param goldbach estructura de datos
+ * @param sieve criba compartida con los números primos del lote
+ * @param table tabla compartida de cantidades de sumas, puede ser NULL
+ */
+void goldbach_run(goldbach_t* goldbach, sieve_t* sieve, count_table_t* table);
+
+/**
+ * @brief Estima el costo de goldbach_run para la entrada
+ * @details Se expresa en consultas a la criba, igual que
+ *          count_table_estimate_cost. Depende de la paridad y la magnitud
+ *          del valor y de si la tabla lo responde, de forma que el solver
+ *          pueda calcular primero las entradas más caras.
  * @code
- *  goldbach_sums_t* goldbach_sums = goldbach_sums_create("31");
+ *  uint64_t cost = goldbach_estimate_cost(goldbach, sieve, NULL);
  * @endcode
- * @param entry cadena de caracteres a evaluar 
- * @return goldbach_sums_t* estructura de datos 
+ * @param goldbach estructura de datos
+ * @param sieve criba compartida con los números primos del lote
+ * @param table tabla compartida de cantidades de sumas, puede ser NULL
+ * @return uint64_t costo estimado, al menos uno
+ */
+uint64_t goldbach_estimate_cost(goldbach_t* goldbach, sieve_t* sieve,
+                                count_table_t* table);
+
+/**
+ * @brief Indica si la entrada solicita listar sus sumas
+ * @code
+ *  bool is_listed = goldbach_is_listed(goldbach);
+ * @endcode
+ * @param goldbach estructura de datos
+ * @return
+ *   true: si la entrada es válida y negativa
+ *   false: en otro caso
+ */
+bool goldbach_is_listed(goldbach_t* goldbach);
+
+/**
+ * @brief Retorna el valor numérico de la entrada
+ * @code
+ *  uint64_t value = goldbach_get_value(goldbach);
+ * @endcode
+ * @param goldbach estructura de datos
+ * @return uint64_t valor absoluto de la entrada, o cero si no es válida
+ */
+uint64_t goldbach_get_value(goldbach_t* goldbach);
+
+/**
+ * @brief Retorna la cantidad de Sumas de Goldbach calculada
+ * @code
+ *  uint64_t count = goldbach_get_count(goldbach);
+ * @endcode
+ * @param goldbach estructura de datos
+ * @return uint64_t cantidad de sumas, cero si no aplica
+ */
+uint64_t goldbach_get_count(goldbach_t* goldbach);
+
+/**
+ * @brief Asigna un resultado calculado por otra entrada con el mismo valor
+ * @code
+ *  goldbach_share_result(goldbach, 3);
+ * @endcode
+ * @param goldbach estructura de datos
+ * @param count cantidad de Sumas de Goldbach
  */
-goldbach_t* goldbach_create(char* entry);
+void goldbach_share_result(goldbach_t* goldbach, uint64_t count);
 
 /**
- * @brief Se invocan los métodos de cálculo de números primos y sumas
+ * @brief Enumera las Sumas de Goldbach de la entrada sin guardarlas
+ * @details Invoca a visitor con cada suma en orden ascendente, directamente
+ *          desde el recorrido de la criba, por lo que la memoria no depende
+ *          de la cantidad de sumas. Se recorre en el hilo que lo invoca,
+ *          pues el orden se debe conservar. Las entradas inválidas o menores
+ *          o iguales a cinco no tienen sumas. A diferencia de goldbach_run,
+ *          no guarda el texto de las sumas.
  * @code
- *  goldbach_run(goldbach);
+ *  uint64_t count = goldbach_enumerate(goldbach, sieve, print_sum, &writer);
  * @endcode
  * @param goldbach estructura de datos
+ * @param sieve criba con los números primos hasta al menos el valor o hasta
+ *        SIEVE_MAX_LIMIT
+ * @param visitor función que recibe cada suma
+ * @param data datos que se entregan a visitor
+ * @return uint64_t cantidad de sumas enumeradas
  */
-void goldbach_run(goldbach_t* goldbach);
+uint64_t goldbach_enumerate(goldbach_t* goldbach, sieve_t* sieve,
+                            goldbach_visitor_t visitor, void* data);
 
 /**
  * @brief Imprime con formato las sumas de goldbach
  * @details Imprime las Sumas de Goldbach correspondientes con un formato
  *          adecuado dependiendo de el valor de ciertos campos de la 
  *          estructura como is_valid, is_negative, is_even_number se 
- *          imprimirá en consola con un formato u otro
+ *          imprimirá en consola con un formato u otro. La salida se
+ *          acumula en el búfer de writer, quien la escribe al llenarse. Las
+ *          sumas de las entradas negativas se enumeran con
+ *          goldbach_enumerate a medida que se escriben, por lo que listar
+ *          un valor cuesta el ancho de banda de la salida y no memoria.
  * @code
- *  goldbach_print(goldbach);
+ *  goldbach_print(goldbach, sieve, &writer);
  * @endcode
  * @param goldbach estructura de datos
+ * @param sieve criba con la que se calculó la entrada
+ * @param writer búfer de salida donde se imprime
  */
-void goldbach_print(goldbach_t* goldbach);
+void goldbach_print(goldbach_t* goldbach, sieve_t* sieve, writer_t* writer);
 
 /**
  * @brief Destructor, libera la memoria de las estructuras de datos empleadas
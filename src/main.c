@@ -5,6 +5,13 @@
 #include "solver.h"
 
 int main(int argc, char* argv[]) {
+  int rank = 0;
+#ifdef GOLDBACH_MPI
+  // Solo el hilo principal de cada proceso invoca a MPI
+  int provided = 0;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
   solver_t* solver = solver_create();
   struct timespec start_time, finish_time;
   clock_gettime(CLOCK_MONOTONIC, &start_time);
@@ -12,7 +19,14 @@ int main(int argc, char* argv[]) {
   clock_gettime(CLOCK_MONOTONIC, &finish_time);
   double elapsed_time = finish_time.tv_sec - start_time.tv_sec +
         (finish_time.tv_nsec - start_time.tv_nsec) / 1000000000.0;
-  printf("\nElapsed time: %.9lfs\n", elapsed_time);
+  // El tiempo va a stderr para que la salida estándar sea solo el resultado
+  if (rank == 0) {
+    fflush(stdout);
+    fprintf(stderr, "\nElapsed time: %.9lfs\n", elapsed_time);
+  }
   solver_destroy(solver);
+#ifdef GOLDBACH_MPI
+  MPI_Finalize();
+#endif
   return EXIT_SUCCESS;
 }
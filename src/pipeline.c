@@ -0,0 +1,210 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "pipeline.h"
+
+/**
+ * @brief Calcula las entradas de la cola hasta que el lector termine
+ * @details Cada hilo de cálculo toma la siguiente entrada sin reclamar, la
+ *          calcula con la criba asignada por el lector, o toma su resultado
+ *          del caché si el valor se repite, y la marca como lista, avisando
+ *          al escritor si es la siguiente a imprimir
+ * @code
+ *   pthread_create(&thread, NULL, pipeline_compute, pipeline);
+ * @endcode
+ * @param data estructura pipeline_t
+ * @return void* NULL
+ */
+void* pipeline_compute(void* data);
+
+/**
+ * @brief Imprime las entradas de la cola en el orden de llegada
+ * @details Espera a que la siguiente entrada esté lista, la imprime fuera
+ *          de la sección crítica en su propio búfer de salida y libera su
+ *          espacio para el lector. Vacía el búfer y la salida estándar cada
+ *          vez que debe esperar, de forma que el uso interactivo obtiene cada
+ *          resultado en cuanto se calcula.
+ * @code
+ *   pthread_create(&thread, NULL, pipeline_print, pipeline);
+ * @endcode
+ * @param data estructura pipeline_t
+ * @return void* NULL
+ */
+void* pipeline_print(void* data);
+
+pipeline_t* pipeline_create(engine_t* engine, stats_t* stats) {
+  assert(engine);
+  // Crear e inicializar campos de la estructura
+  pipeline_t* pipeline = (pipeline_t*) calloc(1, sizeof(pipeline_t));
+  pipeline -> thread_count = engine_get_thread_count(engine);
+  pipeline -> window = PIPELINE_WINDOW_FACTOR * pipeline -> thread_count;
+  pipeline -> engine = engine;
+  pipeline -> stats = stats;
+  pipeline -> slots = (goldbach_t**) calloc(pipeline -> window,
+                                            sizeof(goldbach_t*));
+  pipeline -> slot_sieves = (sieve_t**) calloc(pipeline -> window,
+                                               sizeof(sieve_t*));
+  pipeline -> slot_done = (bool*) calloc(pipeline -> window, sizeof(bool));
+  pthread_mutex_init(&pipeline -> mutex, NULL);
+  pthread_cond_init(&pipeline -> can_read, NULL);
+  pthread_cond_init(&pipeline -> can_compute, NULL);
+  pthread_cond_init(&pipeline -> can_print, NULL);
+  return pipeline;
+}
+
+void pipeline_run(pipeline_t* pipeline, FILE* input) {
+  assert(pipeline);
+  reader_t reader;
+  const char* token = NULL;
+  uint32_t length = 0;
+  stats_t* stats = pipeline -> stats;
+  stats_mark_t run_start;
+  stats_mark(stats, &run_start);
+  pthread_t* threads = (pthread_t*) malloc((pipeline -> thread_count + 1)
+                                           * sizeof(pthread_t));
+  // Iniciar los hilos de cálculo y el hilo escritor
+  for (uint32_t index = 0; index < pipeline -> thread_count; ++index)
+    pthread_create(&threads[index], NULL, pipeline_compute, pipeline);
+  pthread_create(&threads[pipeline -> thread_count], NULL, pipeline_print,
+                 pipeline);
+  // Agregar cada entrada a la cola, esperando si la ventana está llena
+  reader_init(&reader, input);
+  stats_mark_t start;
+  stats_mark(stats, &start);
+  while (reader_next(&reader, &token, &length)) {
+    goldbach_t* goldbach = goldbach_create(token, length, NULL);
+    uint64_t value = goldbach_get_value(goldbach);
+    if (stats) {
+      stats_count_entry(stats, value);
+      stats_add_phase(stats, STATS_READ, &start);
+      stats_mark(stats, &start);
+    }
+    sieve_t* sieve = engine_get_sieve(pipeline -> engine, goldbach);
+    if (stats)
+      stats_add_phase(stats, STATS_SIEVE, &start);
+    pthread_mutex_lock(&pipeline -> mutex);
+    while (pipeline -> read_count - pipeline -> print_count ==
+           pipeline -> window)
+      pthread_cond_wait(&pipeline -> can_read, &pipeline -> mutex);
+    uint32_t slot = pipeline -> read_count % pipeline -> window;
+    pipeline -> slots[slot] = goldbach;
+    pipeline -> slot_sieves[slot] = sieve;
+    ++pipeline -> read_count;
+    pthread_cond_signal(&pipeline -> can_compute);
+    pthread_mutex_unlock(&pipeline -> mutex);
+    if (stats)
+      stats_mark(stats, &start);
+  }
+  reader_destroy(&reader);
+  // Avisar a los demás hilos que no hay más entradas
+  pthread_mutex_lock(&pipeline -> mutex);
+  pipeline -> is_finished = true;
+  pthread_cond_broadcast(&pipeline -> can_compute);
+  pthread_cond_broadcast(&pipeline -> can_print);
+  pthread_mutex_unlock(&pipeline -> mutex);
+  for (uint32_t index = 0; index <= pipeline -> thread_count; ++index)
+    pthread_join(threads[index], NULL);
+  free(threads);
+  if (stats)
+    stats_add_phase(stats, STATS_SUMS, &run_start);
+}
+
+void* pipeline_compute(void* data) {
+  pipeline_t* pipeline = (pipeline_t*) data;
+  pthread_mutex_lock(&pipeline -> mutex);
+  // Número del hilo para sus mediciones
+  uint32_t thread = pipeline -> started_count++;
+  while (true) {
+    // Esperar a que haya una entrada sin reclamar o a que termine la lectura
+    while (pipeline -> claim_count == pipeline -> read_count &&
+           !pipeline -> is_finished)
+      pthread_cond_wait(&pipeline -> can_compute, &pipeline -> mutex);
+    if (pipeline -> claim_count == pipeline -> read_count)
+      break;
+    uint64_t sequence = pipeline -> claim_count++;
+    uint32_t slot = sequence % pipeline -> window;
+    // Calcular fuera de la sección crítica, nadie más usa este espacio
+    pthread_mutex_unlock(&pipeline -> mutex);
+    goldbach_t* goldbach = pipeline -> slots[slot];
+    stats_mark_t start;
+    if (pipeline -> stats)
+      stats_start_busy(pipeline -> stats, &start);
+    engine_t* engine = pipeline -> engine;
+    result_cache_run(engine_get_cache(engine), goldbach,
+                     pipeline -> slot_sieves[slot], engine_get_table(engine));
+    if (pipeline -> stats) {
+      stats_add_busy(pipeline -> stats, thread, &start,
+                     goldbach_get_value(goldbach));
+    }
+    pthread_mutex_lock(&pipeline -> mutex);
+    pipeline -> slot_done[slot] = true;
+    if (sequence == pipeline -> print_count)
+      pthread_cond_signal(&pipeline -> can_print);
+  }
+  pthread_mutex_unlock(&pipeline -> mutex);
+  return NULL;
+}
+
+void* pipeline_print(void* data) {
+  pipeline_t* pipeline = (pipeline_t*) data;
+  writer_t writer;
+  writer_init(&writer, stdout);
+  pthread_mutex_lock(&pipeline -> mutex);
+  while (true) {
+    uint32_t slot = pipeline -> print_count % pipeline -> window;
+    if (pipeline -> print_count < pipeline -> read_count &&
+        pipeline -> slot_done[slot]) {
+      // Imprimir fuera de la sección crítica y liberar el espacio
+      goldbach_t* goldbach = pipeline -> slots[slot];
+      sieve_t* sieve = pipeline -> slot_sieves[slot];
+      pthread_mutex_unlock(&pipeline -> mutex);
+      stats_mark_t start;
+      if (pipeline -> stats)
+        stats_mark(pipeline -> stats, &start);
+      goldbach_print(goldbach, sieve, &writer);
+      goldbach_destroy(goldbach);
+      if (pipeline -> stats)
+        stats_add_phase(pipeline -> stats, STATS_PRINT, &start);
+      pthread_mutex_lock(&pipeline -> mutex);
+      pipeline -> slot_done[slot] = false;
+      ++pipeline -> print_count;
+      pthread_cond_signal(&pipeline -> can_read);
+    } else if (pipeline -> is_finished &&
+               pipeline -> print_count == pipeline -> read_count) {
+      break;
+    } else {
+      // Entregar lo impreso antes de esperar la siguiente entrada
+      pthread_mutex_unlock(&pipeline -> mutex);
+      stats_mark_t start;
+      if (pipeline -> stats)
+        stats_mark(pipeline -> stats, &start);
+      writer_flush(&writer);
+      fflush(stdout);
+      if (pipeline -> stats)
+        stats_add_phase(pipeline -> stats, STATS_PRINT, &start);
+      pthread_mutex_lock(&pipeline -> mutex);
+      if ((pipeline -> print_count == pipeline -> read_count &&
+           !pipeline -> is_finished) ||
+          (pipeline -> print_count < pipeline -> read_count &&
+           !pipeline -> slot_done[slot]))
+        pthread_cond_wait(&pipeline -> can_print, &pipeline -> mutex);
+    }
+  }
+  pthread_mutex_unlock(&pipeline -> mutex);
+  writer_destroy(&writer);
+  return NULL;
+}
+
+void pipeline_destroy(pipeline_t* pipeline) {
+  assert(pipeline);
+  // Liberar memoria empleada por la estructura, las cribas son de engine
+  pthread_mutex_destroy(&pipeline -> mutex);
+  pthread_cond_destroy(&pipeline -> can_read);
+  pthread_cond_destroy(&pipeline -> can_compute);
+  pthread_cond_destroy(&pipeline -> can_print);
+  free(pipeline -> slots);
+  free(pipeline -> slot_sieves);
+  free(pipeline -> slot_done);
+  free(pipeline);
+}
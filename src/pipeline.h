@@ -0,0 +1,87 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "sieve.h"
+#include "engine_internal.h"
+#include "goldbach.h"
+#include "reader.h"
+#include "result_cache.h"
+#include "stats.h"
+
+/// Entradas en vuelo que admite la ventana por cada hilo de cálculo
+#define PIPELINE_WINDOW_FACTOR 16
+
+/**
+ * @brief Estructura de datos que calcula las Sumas de Goldbach de un flujo
+ *        de entradas sin leerlo completo
+ * @details Un hilo lector agrega cada entrada a una cola circular acotada de
+ *          window espacios, los hilos de cálculo toman las entradas en el
+ *          orden de llegada y un hilo escritor imprime cada resultado en
+ *          cuanto la entrada anterior ya fue impresa. Como la cola nunca
+ *          guarda más de window entradas la memoria no depende del tamaño de
+ *          la entrada. Las cribas, el caché y la tabla son los de engine,
+ *          cuya criba crece a medida que llegan valores mayores.
+ */
+typedef struct pipeline {
+  uint32_t thread_count;
+  uint32_t window;
+  uint64_t read_count;
+  uint64_t claim_count;
+  uint64_t print_count;
+  uint32_t started_count;
+  bool is_finished;
+  goldbach_t** slots;
+  sieve_t** slot_sieves;
+  bool* slot_done;
+  engine_t* engine;
+  stats_t* stats;
+  pthread_mutex_t mutex;
+  pthread_cond_t can_read;
+  pthread_cond_t can_compute;
+  pthread_cond_t can_print;
+} pipeline_t;
+
+/**
+ * @brief Constructor, inicializa los campos de la estructura
+ * @code
+ *   pipeline_t* pipeline = pipeline_create(engine, NULL);
+ * @endcode
+ * @param engine contexto de cálculo compartido, cuyos thread_count hilos
+ *        calculan, debe existir hasta que se destruya la estructura
+ * @param stats mediciones de la corrida, o NULL para no medir
+ * @return pipeline_t* estructura de datos
+ */
+pipeline_t* pipeline_create(engine_t* engine, stats_t* stats);
+
+/**
+ * @brief Lee las entradas de input e imprime sus resultados en orden
+ * @details El hilo que invoca este método actúa como lector y retorna
+ *          cuando se imprimió el resultado de la última entrada
+ * @code
+ *   pipeline_run(pipeline, stdin);
+ * @endcode
+ * @param pipeline estructura de datos
+ * @param input archivo del cual se leen las entradas
+ */
+void pipeline_run(pipeline_t* pipeline, FILE* input);
+
+/**
+ * @brief Destructor, libera la memoria de la estructura
+ * @code
+ *   pipeline_destroy(pipeline);
+ * @endcode
+ * @param pipeline estructura de datos
+ */
+void pipeline_destroy(pipeline_t* pipeline);
+
+#endif  // !PIPELINE_H
@@ -0,0 +1,349 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "pool.h"
+
+/// Hilo del pool que ejecuta el código actual, NULL fuera de los pools
+static __thread pool_worker_t* pool_current;
+
+/**
+ * @brief Cuerpo de los hilos del pool, ejecuta trozos hasta pool_destroy
+ * @code
+ *   pthread_create(&thread, NULL, pool_work, &pool -> workers[index]);
+ * @endcode
+ * @param data estructura pool_worker_t
+ * @return void* NULL
+ */
+void* pool_work(void* data);
+
+/**
+ * @brief Ejecuta las tareas de un trozo y las descuenta de su grupo
+ * @details Si el grupo se completa cambia version para despertar a quien
+ *          lo espera
+ * @code
+ *   pool_execute(pool, &item, thread);
+ * @endcode
+ * @param pool estructura de datos
+ * @param item trozo a ejecutar
+ * @param thread número del hilo que lo ejecuta
+ */
+void pool_execute(pool_t* pool, pool_item_t* item, uint32_t thread);
+
+/**
+ * @brief Espera en has_news a que version cambie o el pool se detenga
+ * @code
+ *   pool_sleep(pool, version);
+ * @endcode
+ * @param pool estructura de datos
+ * @param version valor de version leído antes de buscar trozos, de modo que
+ *        un cambio posterior no se pierde
+ */
+void pool_sleep(pool_t* pool, uint64_t version);
+
+/**
+ * @brief Agrega un trozo al fondo de la cola de un hilo
+ * @code
+ *   pool_push(pool, thread, &item);
+ * @endcode
+ * @param pool estructura de datos
+ * @param thread número del hilo dueño de la cola
+ * @param item trozo a agregar
+ */
+void pool_push(pool_t* pool, uint32_t thread, const pool_item_t* item);
+
+/**
+ * @brief Toma el trozo del fondo de la cola de un hilo
+ * @details Con un grupo toma el más cercano al fondo que le pertenece,
+ *          pues un hilo fuera del pool puede haber agregado encima un trozo
+ *          de otro grupo que nadie más está libre para robar
+ * @code
+ *   bool has_item = pool_take(pool, thread, NULL, &item);
+ * @endcode
+ * @param pool estructura de datos
+ * @param thread número del hilo dueño de la cola
+ * @param group grupo al que debe pertenecer el trozo, o NULL para cualquiera
+ * @param item trozo tomado
+ * @return
+ *   true: si la cola tenía un trozo del grupo
+ *   false: si la cola no tenía trozos del grupo
+ */
+bool pool_take(pool_t* pool, uint32_t thread, pool_group_t* group,
+               pool_item_t* item);
+
+/**
+ * @brief Roba el trozo del frente de la cola de otro hilo
+ * @details Revisa las colas a partir del hilo siguiente a thief, de forma
+ *          que los ladrones no empiecen todos por la misma víctima
+ * @code
+ *   bool has_item = pool_steal(pool, thread, &item);
+ * @endcode
+ * @param pool estructura de datos
+ * @param thief número del hilo que roba
+ * @param item trozo robado
+ * @return
+ *   true: si alguna cola tenía trozos
+ *   false: si todas las colas estaban vacías
+ */
+bool pool_steal(pool_t* pool, uint32_t thief, pool_item_t* item);
+
+/**
+ * @brief Fija el hilo que lo invoca a uno de los procesadores permitidos
+ * @code
+ *   pool_pin(pool, 3);
+ * @endcode
+ * @param pool estructura de datos con la afinidad original del proceso
+ * @param thread número del hilo, elige el procesador de forma cíclica
+ */
+void pool_pin(pool_t* pool, uint32_t thread);
+
+pool_t* pool_create(uint32_t thread_count, bool is_pinned) {
+  // Crear e inicializar campos de la estructura
+  pool_t* pool = (pool_t*) calloc(1, sizeof(pool_t));
+  pool -> thread_count = thread_count ? thread_count : 1;
+  pool -> is_pinned = is_pinned;
+  pool -> threads = (pthread_t*) calloc(pool -> thread_count,
+                                        sizeof(pthread_t));
+  pool -> workers = (pool_worker_t*) calloc(pool -> thread_count,
+                                            sizeof(pool_worker_t));
+  // Alinear las colas para que cada una empiece en su propia línea
+  pool -> deques = (pool_deque_t*) aligned_alloc(POOL_CACHE_LINE_SIZE,
+      pool -> thread_count * sizeof(pool_deque_t));
+  memset(pool -> deques, 0, pool -> thread_count * sizeof(pool_deque_t));
+  pthread_mutex_init(&pool -> mutex, NULL);
+  pthread_cond_init(&pool -> has_news, NULL);
+  // Guardar los procesadores permitidos para repartirlos entre los hilos
+  CPU_ZERO(&pool -> affinity);
+  if (is_pinned && pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                          &pool -> affinity) != 0)
+    pool -> is_pinned = false;
+  for (uint32_t index = 0; index < pool -> thread_count; ++index) {
+    pthread_mutex_init(&pool -> deques[index].mutex, NULL);
+    pool -> workers[index].pool = pool;
+    pool -> workers[index].index = index;
+  }
+  for (uint32_t index = 0; index < pool -> thread_count; ++index) {
+    pthread_create(&pool -> threads[index], NULL, pool_work,
+                   &pool -> workers[index]);
+  }
+  return pool;
+}
+
+void pool_run(pool_t* pool, uint32_t task_count, pool_task_t task,
+              void* data) {
+  assert(pool);
+  pool_group_t group = {0};
+  pool_spawn(pool, &group, task_count, task, data);
+  pool_wait(pool, &group);
+}
+
+void pool_spawn(pool_t* pool, pool_group_t* group, uint32_t task_count,
+                pool_task_t task, void* data) {
+  assert(pool);
+  assert(group);
+  assert(task);
+  if (task_count == 0)
+    return;
+  uint32_t thread_count = pool -> thread_count;
+  uint32_t chunk_size = task_count / (thread_count * POOL_CHUNK_FACTOR);
+  if (chunk_size == 0)
+    chunk_size = 1;
+  uint32_t chunk_count = (task_count + chunk_size - 1) / chunk_size;
+  // Contar las tareas antes de que algún hilo pueda terminarlas
+  pthread_mutex_lock(&pool -> mutex);
+  group -> pending_count += task_count;
+  uint32_t first_deque = pool -> next_deque;
+  pool -> next_deque = (first_deque + chunk_count) % thread_count;
+  pthread_mutex_unlock(&pool -> mutex);
+  pool_worker_t* worker = pool_current;
+  bool is_own = worker && worker -> pool == pool;
+  /* Agregar del último trozo al primero, pues cada dueño toma del fondo y
+     así empieza por las tareas de menor número */
+  for (uint32_t chunk = chunk_count; chunk-- > 0;) {
+    pool_item_t item = {task, data, chunk * chunk_size,
+                        chunk * chunk_size + chunk_size < task_count
+                        ? chunk * chunk_size + chunk_size : task_count,
+                        group};
+    pool_push(pool, is_own ? worker -> index
+                           : (first_deque + chunk) % thread_count, &item);
+  }
+  // Despertar a los hilos que esperan trozos
+  pthread_mutex_lock(&pool -> mutex);
+  ++pool -> version;
+  if (pool -> sleeping_count > 0)
+    pthread_cond_broadcast(&pool -> has_news);
+  pthread_mutex_unlock(&pool -> mutex);
+}
+
+void pool_wait(pool_t* pool, pool_group_t* group) {
+  assert(pool);
+  assert(group);
+  pool_worker_t* worker = pool_current;
+  bool is_own = worker && worker -> pool == pool;
+  while (true) {
+    pthread_mutex_lock(&pool -> mutex);
+    uint64_t version = pool -> version;
+    bool is_done = group -> pending_count == 0;
+    pthread_mutex_unlock(&pool -> mutex);
+    if (is_done)
+      break;
+    /* Un hilo del pool ejecuta los trozos del grupo que siguen en su cola,
+       los demás los roban del frente */
+    pool_item_t item;
+    if (is_own && pool_take(pool, worker -> index, group, &item))
+      pool_execute(pool, &item, worker -> index);
+    else
+      pool_sleep(pool, version);
+  }
+}
+
+pool_t* pool_get_current() {
+  return pool_current ? pool_current -> pool : NULL;
+}
+
+void* pool_work(void* data) {
+  pool_worker_t* worker = (pool_worker_t*) data;
+  pool_t* pool = worker -> pool;
+  pool_current = worker;
+  if (pool -> is_pinned)
+    pool_pin(pool, worker -> index);
+  while (true) {
+    pthread_mutex_lock(&pool -> mutex);
+    uint64_t version = pool -> version;
+    bool is_stopping = pool -> is_stopping;
+    pthread_mutex_unlock(&pool -> mutex);
+    if (is_stopping)
+      break;
+    // Vaciar la cola propia y luego ayudar a los hilos que sigan ocupados
+    pool_item_t item;
+    if (pool_take(pool, worker -> index, NULL, &item) ||
+        pool_steal(pool, worker -> index, &item))
+      pool_execute(pool, &item, worker -> index);
+    else
+      pool_sleep(pool, version);
+  }
+  return NULL;
+}
+
+void pool_execute(pool_t* pool, pool_item_t* item, uint32_t thread) {
+  for (uint32_t index = item -> first; index < item -> last; ++index)
+    item -> task(item -> data, index, thread);
+  pthread_mutex_lock(&pool -> mutex);
+  item -> group -> pending_count -= item -> last - item -> first;
+  if (item -> group -> pending_count == 0) {
+    ++pool -> version;
+    if (pool -> sleeping_count > 0)
+      pthread_cond_broadcast(&pool -> has_news);
+  }
+  pthread_mutex_unlock(&pool -> mutex);
+}
+
+void pool_sleep(pool_t* pool, uint64_t version) {
+  pthread_mutex_lock(&pool -> mutex);
+  while (pool -> version == version && !pool -> is_stopping) {
+    ++pool -> sleeping_count;
+    pthread_cond_wait(&pool -> has_news, &pool -> mutex);
+    --pool -> sleeping_count;
+  }
+  pthread_mutex_unlock(&pool -> mutex);
+}
+
+void pool_push(pool_t* pool, uint32_t thread, const pool_item_t* item) {
+  pool_deque_t* deque = &pool -> deques[thread];
+  pthread_mutex_lock(&deque -> mutex);
+  if (deque -> head + deque -> count == deque -> capacity) {
+    // Mover los trozos al inicio o, si ya están ahí, duplicar la capacidad
+    if (deque -> head > 0) {
+      memmove(deque -> items, deque -> items + deque -> head,
+              deque -> count * sizeof(pool_item_t));
+      deque -> head = 0;
+    } else {
+      deque -> capacity = deque -> capacity ? 2 * deque -> capacity
+                                            : POOL_CHUNK_FACTOR;
+      deque -> items = (pool_item_t*) realloc(deque -> items,
+                                              deque -> capacity
+                                              * sizeof(pool_item_t));
+    }
+  }
+  deque -> items[deque -> head + deque -> count++] = *item;
+  pthread_mutex_unlock(&deque -> mutex);
+}
+
+bool pool_take(pool_t* pool, uint32_t thread, pool_group_t* group,
+               pool_item_t* item) {
+  pool_deque_t* deque = &pool -> deques[thread];
+  bool has_item = false;
+  pthread_mutex_lock(&deque -> mutex);
+  for (uint32_t position = deque -> count; position-- > 0 && !has_item;) {
+    pool_item_t* candidate = &deque -> items[deque -> head + position];
+    if (!group || candidate -> group == group) {
+      *item = *candidate;
+      // Cerrar el hueco con los trozos que estaban más cerca del fondo
+      memmove(candidate, candidate + 1,
+              (deque -> count - position - 1) * sizeof(pool_item_t));
+      if (--deque -> count == 0)
+        deque -> head = 0;
+      has_item = true;
+    }
+  }
+  pthread_mutex_unlock(&deque -> mutex);
+  return has_item;
+}
+
+bool pool_steal(pool_t* pool, uint32_t thief, pool_item_t* item) {
+  for (uint32_t offset = 1; offset < pool -> thread_count; ++offset) {
+    uint32_t victim = (thief + offset) % pool -> thread_count;
+    pool_deque_t* deque = &pool -> deques[victim];
+    bool has_item = false;
+    pthread_mutex_lock(&deque -> mutex);
+    if (deque -> count > 0) {
+      *item = deque -> items[deque -> head++];
+      if (--deque -> count == 0)
+        deque -> head = 0;
+      has_item = true;
+    }
+    pthread_mutex_unlock(&deque -> mutex);
+    if (has_item)
+      return true;
+  }
+  return false;
+}
+
+void pool_pin(pool_t* pool, uint32_t thread) {
+  int cpu_count = CPU_COUNT(&pool -> affinity);
+  if (cpu_count == 0)
+    return;
+  // Buscar el procesador permitido número thread % cpu_count
+  int target = (int) (thread % (uint32_t) cpu_count);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &pool -> affinity) && target-- == 0) {
+      cpu_set_t single;
+      CPU_ZERO(&single);
+      CPU_SET(cpu, &single);
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &single);
+      break;
+    }
+  }
+}
+
+void pool_destroy(pool_t* pool) {
+  assert(pool);
+  // Despertar a los hilos para que terminen y esperarlos
+  pthread_mutex_lock(&pool -> mutex);
+  pool -> is_stopping = true;
+  pthread_cond_broadcast(&pool -> has_news);
+  pthread_mutex_unlock(&pool -> mutex);
+  for (uint32_t index = 0; index < pool -> thread_count; ++index)
+    pthread_join(pool -> threads[index], NULL);
+  // Liberar memoria empleada por la estructura
+  for (uint32_t index = 0; index < pool -> thread_count; ++index) {
+    free(pool -> deques[index].items);
+    pthread_mutex_destroy(&pool -> deques[index].mutex);
+  }
+  pthread_mutex_destroy(&pool -> mutex);
+  pthread_cond_destroy(&pool -> has_news);
+  free(pool -> deques);
+  free(pool -> workers);
+  free(pool -> threads);
+  free(pool);
+}
@@ -0,0 +1,190 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef POOL_H
+#define POOL_H
+// pthread_setaffinity_np y CPU_SET son extensiones de GNU
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+/// Trozos en que se divide el trabajo por cada hilo del pool
+#define POOL_CHUNK_FACTOR 16
+/// Tamaño de una línea de caché, al que se alinea cada cola de trozos
+#define POOL_CACHE_LINE_SIZE 64
+
+/**
+ * @brief Función que ejecuta el pool para cada tarea
+ * @code
+ *   void compute_entry(void* data, uint32_t index, uint32_t thread);
+ * @endcode
+ * @param data datos indicados a pool_run o pool_spawn
+ * @param index número de la tarea, de 0 a task_count - 1
+ * @param thread número del hilo que la ejecuta, de 0 a thread_count - 1
+ */
+typedef void (*pool_task_t)(void* data, uint32_t index, uint32_t thread);
+
+/**
+ * @brief Grupo de tareas que se espera con pool_wait
+ * @details Se inicializa en cero, pool_spawn suma sus tareas a
+ *          pending_count y cada trozo ejecutado las resta
+ */
+typedef struct pool_group {
+  uint32_t pending_count;
+} pool_group_t;
+
+/// Trozo de tareas consecutivas [first, last) de una invocación de pool_spawn
+typedef struct pool_item {
+  pool_task_t task;
+  void* data;
+  uint32_t first;
+  uint32_t last;
+  pool_group_t* group;
+} pool_item_t;
+
+/**
+ * @brief Cola doble de trozos de un hilo del pool
+ * @details Los trozos pendientes son items[head] a items[head + count - 1].
+ *          El dueño agrega y toma del fondo, de modo que primero ejecuta los
+ *          trozos que acaba de crear, y los demás hilos roban del frente los
+ *          más antiguos. Cada cola se alinea a una línea de caché y su
+ *          tamaño se redondea a un múltiplo de ella, de modo que en el
+ *          arreglo reservado con aligned_alloc los hilos no comparten líneas
+ *          al tomar trozos.
+ */
+typedef struct pool_deque {
+  pool_item_t* items;
+  uint32_t head;
+  uint32_t count;
+  uint32_t capacity;
+  pthread_mutex_t mutex;
+} __attribute__((aligned(POOL_CACHE_LINE_SIZE))) pool_deque_t;
+
+_Static_assert(sizeof(pool_deque_t) % POOL_CACHE_LINE_SIZE == 0,
+               "pool_deque_t must fill whole cache lines");
+
+/// Datos que recibe cada hilo del pool al iniciar
+typedef struct pool_worker {
+  struct pool* pool;
+  uint32_t index;
+} pool_worker_t;
+
+/**
+ * @brief Estructura de datos que reparte tareas entre hilos de pthreads
+ *        con robo de trabajo
+ * @details Los hilos se crean una vez y viven hasta pool_destroy. Las
+ *          tareas se agrupan en trozos consecutivos; los de un hilo externo
+ *          se reparten de forma cíclica entre las colas de los hilos, de
+ *          modo que si vienen ordenadas por costo cada hilo recibe una
+ *          mezcla parecida, y los de un hilo del pool van a su propia cola.
+ *          Cada hilo vacía su cola y después roba trozos del frente de las
+ *          colas de los demás. Un hilo sin trozos espera en has_news a que
+ *          version cambie, lo que ocurre al crear trozos y al completar un
+ *          grupo. Con is_pinned cada hilo se fija a uno de los procesadores
+ *          que el proceso tiene permitidos, de forma cíclica.
+ */
+typedef struct pool {
+  uint32_t thread_count;
+  bool is_pinned;
+  pthread_t* threads;
+  pool_worker_t* workers;
+  pool_deque_t* deques;
+  cpu_set_t affinity;
+  uint32_t next_deque;
+  uint64_t version;
+  uint32_t sleeping_count;
+  bool is_stopping;
+  pthread_mutex_t mutex;
+  pthread_cond_t has_news;
+} pool_t;
+
+/**
+ * @brief Constructor, crea thread_count hilos que esperan tareas
+ * @details El hilo que lo invoca no es parte del pool, por lo que no se fija
+ *          a ningún procesador
+ * @code
+ *   pool_t* pool = pool_create(8, true);
+ * @endcode
+ * @param thread_count cantidad de hilos
+ * @param is_pinned true para fijar cada hilo a un procesador
+ * @return pool_t* estructura de datos
+ */
+pool_t* pool_create(uint32_t thread_count, bool is_pinned);
+
+/**
+ * @brief Ejecuta task para cada tarea de 0 a task_count - 1 y espera a que
+ *        terminen todas
+ * @details Equivale a pool_spawn seguido de pool_wait con un grupo propio.
+ *          Las tareas de menor número se toman primero en cada cola.
+ * @code
+ *   pool_run(pool, count, compute_entry, &job);
+ * @endcode
+ * @param pool estructura de datos
+ * @param task_count cantidad de tareas
+ * @param task función que ejecuta cada tarea
+ * @param data datos que se entregan a task
+ */
+void pool_run(pool_t* pool, uint32_t task_count, pool_task_t task,
+              void* data);
+
+/**
+ * @brief Agrega task_count tareas al grupo sin esperarlas
+ * @details Desde un hilo del pool los trozos van al fondo de su propia cola,
+ *          de donde los demás hilos los roban, lo que permite dividir una
+ *          tarea en otras. Desde otro hilo se reparten entre todas las
+ *          colas.
+ * @code
+ *   pool_spawn(pool, &group, 64, find_task, &split);
+ * @endcode
+ * @param pool estructura de datos
+ * @param group grupo al que se suman las tareas
+ * @param task_count cantidad de tareas
+ * @param task función que ejecuta cada tarea
+ * @param data datos que se entregan a task
+ */
+void pool_spawn(pool_t* pool, pool_group_t* group, uint32_t task_count,
+                pool_task_t task, void* data);
+
+/**
+ * @brief Espera a que terminen todas las tareas del grupo
+ * @details Un hilo del pool ejecuta mientras tanto los trozos del grupo que
+ *          siguen en su cola; otro hilo solo se bloquea
+ * @code
+ *   pool_wait(pool, &group);
+ * @endcode
+ * @param pool estructura de datos
+ * @param group grupo a esperar
+ */
+void pool_wait(pool_t* pool, pool_group_t* group);
+
+/**
+ * @brief Retorna el pool del hilo que lo invoca
+ * @code
+ *   pool_t* pool = pool_get_current();
+ * @endcode
+ * @return pool_t* pool al que pertenece el hilo, o NULL si no es un hilo
+ *         de ningún pool
+ */
+pool_t* pool_get_current();
+
+/**
+ * @brief Destructor, termina los hilos y libera la memoria de la estructura
+ * @details No debe haber tareas pendientes
+ * @code
+ *   pool_destroy(pool);
+ * @endcode
+ * @param pool estructura de datos
+ */
+void pool_destroy(pool_t* pool);
+
+#endif  // !POOL_H
@@ -0,0 +1,139 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "reader.h"
+
+/**
+ * @brief Lee el siguiente bloque de la entrada al final del búfer
+ * @details Primero mueve al inicio del búfer los caracteres desde position,
+ *          que pueden ser un token incompleto, y duplica la capacidad si el
+ *          búfer quedó lleno. Un archivo proyectado no tiene más bloques.
+ * @code
+ *   bool has_data = reader_fill(reader);
+ * @endcode
+ * @param reader estructura inicializada
+ * @return
+ *   true: si se leyó al menos un caracter
+ *   false: si la entrada terminó
+ */
+bool reader_fill(reader_t* reader);
+
+/**
+ * @brief Indica si character es un espacio en blanco según isspace
+ * @code
+ *   bool is_space = reader_is_space('\n');
+ * @endcode
+ * @param character caracter a revisar
+ * @return
+ *   true: si es ' ', '\t', '\n', '\v', '\f' o '\r'
+ *   false: en otro caso
+ */
+bool reader_is_space(char character);
+
+void reader_init(reader_t* reader, FILE* file) {
+  assert(reader);
+  assert(file);
+  // Inicializar campos de la estructura
+  reader -> descriptor = fileno(file);
+  reader -> is_mapped = false;
+  reader -> position = 0;
+  reader -> count = 0;
+  // Proyectar en memoria los archivos regulares desde la posición actual
+  struct stat status;
+  off_t offset = lseek(reader -> descriptor, 0, SEEK_CUR);
+  if (fstat(reader -> descriptor, &status) == 0 && S_ISREG(status.st_mode) &&
+      offset >= 0 && status.st_size > offset) {
+    void* mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE,
+                         reader -> descriptor, 0);
+    if (mapping != MAP_FAILED) {
+      madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+      reader -> is_mapped = true;
+      reader -> buffer = (char*) mapping;
+      reader -> capacity = status.st_size;
+      reader -> position = offset;
+      reader -> count = status.st_size;
+      return;
+    }
+  }
+  // Las tuberías y terminales se leen por bloques
+  reader -> capacity = READER_CAPACITY;
+  reader -> buffer = (char*) malloc(reader -> capacity);
+}
+
+void reader_destroy(reader_t* reader) {
+  assert(reader);
+  // Liberar la memoria utilizada por la estructura
+  if (reader -> is_mapped)
+    munmap(reader -> buffer, reader -> capacity);
+  else
+    free(reader -> buffer);
+}
+
+bool reader_next(reader_t* reader, const char** token, uint32_t* length) {
+  assert(reader);
+  // Saltar los espacios en blanco antes del token
+  while (true) {
+    while (reader -> position < reader -> count &&
+           reader_is_space(reader -> buffer[reader -> position]))
+      ++reader -> position;
+    if (reader -> position < reader -> count)
+      break;
+    if (!reader_fill(reader))
+      return false;
+  }
+  size_t start = reader -> position;
+  size_t end = start;
+  // Avanzar hasta el siguiente espacio, leyendo más si el token se corta
+  while (true) {
+    while (end < reader -> count && !reader_is_space(reader -> buffer[end]))
+      ++end;
+    if (end < reader -> count)
+      break;
+    size_t token_length = end - start;
+    reader -> position = start;
+    bool has_data = reader_fill(reader);
+    start = reader -> position;
+    end = start + token_length;
+    if (!has_data)
+      break;
+  }
+  *token = reader -> buffer + start;
+  *length = (uint32_t) (end - start);
+  reader -> position = end;
+  return true;
+}
+
+bool reader_is_buffered(reader_t* reader) {
+  assert(reader);
+  // Descartar los espacios en blanco que siguen al último token
+  while (reader -> position < reader -> count &&
+         reader_is_space(reader -> buffer[reader -> position]))
+    ++reader -> position;
+  return reader -> position < reader -> count;
+}
+
+bool reader_fill(reader_t* reader) {
+  assert(reader);
+  if (reader -> is_mapped)
+    return false;
+  // Conservar el token incompleto al inicio del búfer
+  reader -> count -= reader -> position;
+  memmove(reader -> buffer, reader -> buffer + reader -> position,
+          reader -> count);
+  reader -> position = 0;
+  if (reader -> count == reader -> capacity) {
+    reader -> capacity *= 2;
+    reader -> buffer = (char*) realloc(reader -> buffer, reader -> capacity);
+  }
+  ssize_t bytes = read(reader -> descriptor, reader -> buffer + reader -> count,
+                       reader -> capacity - reader -> count);
+  if (bytes <= 0)
+    return false;
+  reader -> count += bytes;
+  return true;
+}
+
+bool reader_is_space(char character) {
+  return character == ' ' || (character >= '\t' && character <= '\r');
+}
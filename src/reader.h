@@ -0,0 +1,95 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef READER_H
+#define READER_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// Capacidad inicial del búfer de entrada, se duplica si un token no cabe
+#define READER_CAPACITY (1u << 20)
+
+/**
+ * @brief Estructura de datos que separa la entrada en tokens sin copiarlos
+ * @details Si la entrada es un archivo regular se proyecta completo en
+ *          memoria, si no se lee por bloques de READER_CAPACITY bytes con
+ *          read, que retorna en cuanto hay datos y no bloquea el uso
+ *          interactivo. Cada token se entrega como un puntero y una longitud
+ *          dentro de buffer, válidos hasta la siguiente lectura.
+ */
+typedef struct reader {
+  int descriptor;
+  bool is_mapped;
+  char* buffer;
+  size_t capacity;
+  size_t position;
+  size_t count;
+} reader_t;
+
+/**
+ * @brief Inicializador, proyecta file en memoria o reserva el búfer
+ * @code
+ *   reader_init(&reader, stdin);
+ * @endcode
+ * @param reader estructura sin inicializar
+ * @param file archivo del cual se leen los tokens, no se debe haber leído
+ *        con las funciones de stdio
+ */
+void reader_init(reader_t* reader, FILE* file);
+
+/**
+ * @brief Destructor, libera el búfer o la proyección del archivo
+ * @code
+ *   reader_destroy(&reader);
+ * @endcode
+ * @param reader estructura inicializada
+ */
+void reader_destroy(reader_t* reader);
+
+/**
+ * @brief Busca el siguiente token separado por espacios en blanco
+ * @details Sigue las mismas reglas que el formato "%s" de scanf, pero sin
+ *          límite de longitud
+ * @code
+ *   const char* token = NULL;
+ *   uint32_t length = 0;
+ *   while (reader_next(&reader, &token, &length)) {
+ *     //token[0] a token[length - 1] son los caracteres del token
+ *   }
+ * @endcode
+ * @param reader estructura inicializada
+ * @param token dirección donde se guarda el inicio del token
+ * @param length dirección donde se guarda la cantidad de caracteres
+ * @return
+ *   true: si se encontró un token
+ *   false: si la entrada terminó
+ */
+bool reader_next(reader_t* reader, const char** token, uint32_t* length);
+
+/**
+ * @brief Indica si el búfer contiene caracteres del siguiente token, de
+ *        forma que reader_next no empezará bloqueándose en una lectura
+ * @details Permite entregar las respuestas pendientes antes de esperar más
+ *          entrada, como cuando un cliente envía una consulta y espera su
+ *          resultado
+ * @code
+ *   if (!reader_is_buffered(&reader))
+ *     writer_flush(&writer);
+ * @endcode
+ * @param reader estructura inicializada
+ * @return
+ *   true: si queda un caracter que no es espacio en blanco en el búfer
+ *   false: si solo quedan espacios en blanco o nada
+ */
+bool reader_is_buffered(reader_t* reader);
+
+#endif  // !READER_H
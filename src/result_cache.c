@@ -0,0 +1,382 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "result_cache.h"
+
+/// Identificador de los archivos de result_cache_save
+#define RESULT_CACHE_FILE_MAGIC "GBCACHE"
+/// Valor que permite detectar archivos escritos con otro orden de bytes
+#define RESULT_CACHE_BYTE_ORDER 0x01020304u
+
+/// Encabezado de los archivos de result_cache_save
+typedef struct cache_file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t entry_count;
+  uint64_t checksum;
+} cache_file_header_t;
+
+/// Resultado tal como se guarda en los archivos de result_cache_save
+typedef struct cache_record {
+  uint64_t value;
+  uint64_t count;
+} cache_record_t;
+
+/**
+ * @brief Busca el resultado del valor, o lo agrega si no existe
+ * @details Debe invocarse con el mutex del caché bloqueado, que también
+ *          protege al arena donde se reservan los resultados nuevos. El
+ *          resultado encontrado o agregado pasa a ser el más reciente, y si
+ *          el caché está lleno el nuevo reutiliza la memoria del menos
+ *          reciente que se pueda descartar.
+ * @code
+ *   bool is_new = false;
+ *   cache_entry_t* entry = find_entry(cache, 21, &is_new);
+ * @endcode
+ * @param cache estructura de datos
+ * @param value valor absoluto de la entrada
+ * @param is_new dirección donde se indica si el resultado se acaba de agregar
+ * @return cache_entry_t* resultado del valor
+ */
+cache_entry_t* find_entry(result_cache_t* cache, uint64_t value,
+                          bool* is_new);
+
+/**
+ * @brief Duplica la cantidad de listas y redistribuye los resultados
+ * @details Los resultados no se mueven de memoria, solo se enlazan en su
+ *          nueva lista, por lo que las entradas que los comparten no se ven
+ *          afectadas
+ * @code
+ *   expand_buckets(cache);
+ * @endcode
+ * @param cache estructura de datos
+ */
+void expand_buckets(result_cache_t* cache);
+
+/**
+ * @brief Retorna la lista donde se guarda el valor
+ * @code
+ *   uint32_t bucket = hash_key(21, 1024);
+ * @endcode
+ * @param value valor absoluto de la entrada
+ * @param bucket_count cantidad de listas, potencia de dos
+ * @return uint32_t posición de la lista
+ */
+uint32_t hash_key(uint64_t value, uint32_t bucket_count);
+
+/**
+ * @brief Quita un resultado de su lista y de la lista de uso
+ * @details Retorna NULL si no hay resultados listos sin entradas esperando,
+ *          en cuyo caso el caché excede su capacidad temporalmente
+ * @code
+ *   cache_entry_t* entry = evict_entry(cache);
+ * @endcode
+ * @param cache estructura de datos con el mutex bloqueado
+ * @return cache_entry_t* memoria del resultado descartado, o NULL
+ */
+cache_entry_t* evict_entry(result_cache_t* cache);
+
+/**
+ * @brief Enlaza un resultado como el más reciente de la lista de uso
+ * @code
+ *   link_newest(cache, entry);
+ * @endcode
+ * @param cache estructura de datos con el mutex bloqueado
+ * @param entry resultado que no está en la lista de uso
+ */
+void link_newest(result_cache_t* cache, cache_entry_t* entry);
+
+/**
+ * @brief Quita un resultado de la lista de uso
+ * @code
+ *   unlink_entry(cache, entry);
+ * @endcode
+ * @param cache estructura de datos con el mutex bloqueado
+ * @param entry resultado que está en la lista de uso
+ */
+void unlink_entry(result_cache_t* cache, cache_entry_t* entry);
+
+/**
+ * @brief Retorna la suma de verificación FNV-1a de los resultados
+ * @code
+ *   uint64_t checksum = checksum_records(records, count);
+ * @endcode
+ * @param records resultados en el formato del archivo
+ * @param record_count cantidad de resultados
+ * @return uint64_t suma de verificación
+ */
+uint64_t checksum_records(const cache_record_t* records,
+                          uint64_t record_count);
+
+/**
+ * @brief Lee y valida los resultados de un archivo de result_cache_save
+ * @code
+ *   cache_record_t* records = read_records(file, &record_count);
+ * @endcode
+ * @param file archivo abierto para lectura binaria
+ * @param record_count dirección donde se guarda la cantidad de resultados
+ * @return cache_record_t* resultados, se deben liberar con free, o NULL si
+ *         el archivo no tiene un formato válido
+ */
+cache_record_t* read_records(FILE* file, uint64_t* record_count);
+
+result_cache_t* result_cache_create() {
+  // Crear e inicializar campos de la estructura
+  result_cache_t* cache = (result_cache_t*) calloc(1, sizeof(result_cache_t));
+  cache -> capacity = RESULT_CACHE_CAPACITY;
+  cache -> bucket_count = RESULT_CACHE_BUCKET_COUNT;
+  cache -> buckets = (cache_entry_t**) calloc(cache -> bucket_count,
+                                              sizeof(cache_entry_t*));
+  arena_init(&cache -> arena);
+  pthread_mutex_init(&cache -> mutex, NULL);
+  pthread_cond_init(&cache -> is_ready, NULL);
+  return cache;
+}
+
+void result_cache_destroy(result_cache_t* cache) {
+  assert(cache);
+  // Los resultados se liberan de una vez junto con el arena
+  arena_destroy(&cache -> arena);
+  pthread_mutex_destroy(&cache -> mutex);
+  pthread_cond_destroy(&cache -> is_ready);
+  free(cache -> buckets);
+  free(cache);
+}
+
+void result_cache_run(result_cache_t* cache, goldbach_t* goldbach,
+                      sieve_t* sieve, count_table_t* table) {
+  assert(cache);
+  assert(goldbach);
+  uint64_t value = goldbach_get_value(goldbach);
+  // Las entradas inválidas o que no aplican no requieren cálculo
+  if (value <= 5) {
+    goldbach_run(goldbach, sieve, table);
+    return;
+  }
+  bool is_new = false;
+  pthread_mutex_lock(&cache -> mutex);
+  cache_entry_t* entry = find_entry(cache, value, &is_new);
+  if (is_new) {
+    // Calcular fuera de la sección crítica y publicar el resultado
+    pthread_mutex_unlock(&cache -> mutex);
+    goldbach_run(goldbach, sieve, table);
+    pthread_mutex_lock(&cache -> mutex);
+    entry -> count = goldbach_get_count(goldbach);
+    entry -> is_ready = true;
+    pthread_cond_broadcast(&cache -> is_ready);
+    pthread_mutex_unlock(&cache -> mutex);
+    return;
+  }
+  /* Esperar si otro hilo está calculando el mismo valor, sin que el
+     resultado se descarte mientras tanto */
+  ++entry -> waiter_count;
+  while (!entry -> is_ready)
+    pthread_cond_wait(&cache -> is_ready, &cache -> mutex);
+  --entry -> waiter_count;
+  goldbach_share_result(goldbach, entry -> count);
+  pthread_mutex_unlock(&cache -> mutex);
+}
+
+bool result_cache_load(result_cache_t* cache, const char* path) {
+  assert(cache);
+  assert(path);
+  FILE* file = fopen(path, "rb");
+  if (!file)
+    return true;
+  uint64_t record_count = 0;
+  cache_record_t* records = read_records(file, &record_count);
+  fclose(file);
+  if (!records)
+    return false;
+  // Agregar cada cantidad como un resultado listo, la última es la reciente
+  pthread_mutex_lock(&cache -> mutex);
+  for (uint64_t index = 0; index < record_count; ++index) {
+    bool is_new = false;
+    cache_entry_t* entry = find_entry(cache, records[index].value, &is_new);
+    if (is_new) {
+      entry -> count = records[index].count;
+      entry -> is_ready = true;
+    }
+  }
+  pthread_mutex_unlock(&cache -> mutex);
+  free(records);
+  return true;
+}
+
+cache_record_t* read_records(FILE* file, uint64_t* record_count) {
+  cache_file_header_t header;
+  if (fread(&header, sizeof(header), 1, file) != 1)
+    return NULL;
+  // Validar el formato, la versión y el orden de los bytes
+  if (memcmp(header.magic, RESULT_CACHE_FILE_MAGIC, sizeof(header.magic))
+      != 0 || header.version != RESULT_CACHE_FILE_VERSION ||
+      header.byte_order != RESULT_CACHE_BYTE_ORDER ||
+      header.entry_count > RESULT_CACHE_CAPACITY)
+    return NULL;
+  cache_record_t* records = (cache_record_t*) malloc(
+      (header.entry_count + 1) * sizeof(cache_record_t));
+  // El archivo debe terminar justo después del último resultado
+  bool is_valid = fread(records, sizeof(cache_record_t), header.entry_count,
+                        file) == header.entry_count &&
+                  fgetc(file) == EOF &&
+                  checksum_records(records, header.entry_count)
+                    == header.checksum;
+  // Solo se admiten valores que goldbach_create consideraría válidos
+  for (uint64_t index = 0; is_valid && index < header.entry_count; ++index) {
+    uint64_t value = records[index].value;
+    is_valid = value > 5 && value <= (value % 2 == 0 ? GOLDBACH_MAX_VALUE
+                                                     : GOLDBACH_MAX_ODD_VALUE);
+  }
+  if (!is_valid) {
+    free(records);
+    return NULL;
+  }
+  *record_count = header.entry_count;
+  return records;
+}
+
+bool result_cache_save(result_cache_t* cache, const char* path) {
+  assert(cache);
+  assert(path);
+  cache_file_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, RESULT_CACHE_FILE_MAGIC, sizeof(header.magic));
+  header.version = RESULT_CACHE_FILE_VERSION;
+  header.byte_order = RESULT_CACHE_BYTE_ORDER;
+  // Copiar los resultados listos del menos reciente al más reciente
+  pthread_mutex_lock(&cache -> mutex);
+  cache_record_t* records = (cache_record_t*) malloc(
+      ((uint64_t) cache -> entry_count + 1) * sizeof(cache_record_t));
+  for (cache_entry_t* entry = cache -> oldest; entry;
+       entry = entry -> newer) {
+    if (entry -> is_ready) {
+      records[header.entry_count].value = entry -> value;
+      records[header.entry_count++].count = entry -> count;
+    }
+  }
+  pthread_mutex_unlock(&cache -> mutex);
+  header.checksum = checksum_records(records, header.entry_count);
+  FILE* file = fopen(path, "wb");
+  bool is_written = file &&
+    fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(records, sizeof(cache_record_t), header.entry_count, file)
+      == header.entry_count;
+  free(records);
+  return file && fclose(file) == 0 && is_written;
+}
+
+uint64_t checksum_records(const cache_record_t* records,
+                          uint64_t record_count) {
+  const unsigned char* bytes = (const unsigned char*) records;
+  uint64_t checksum = 0xCBF29CE484222325ull;
+  // FNV-1a de 64 bits sobre los bytes de los resultados
+  for (uint64_t index = 0; index < record_count * sizeof(cache_record_t);
+       ++index) {
+    checksum ^= bytes[index];
+    checksum *= 0x100000001B3ull;
+  }
+  return checksum;
+}
+
+cache_entry_t* find_entry(result_cache_t* cache, uint64_t value,
+                          bool* is_new) {
+  uint32_t bucket = hash_key(value, cache -> bucket_count);
+  // Recorrer la lista del valor buscando el resultado
+  for (cache_entry_t* entry = cache -> buckets[bucket]; entry;
+       entry = entry -> next) {
+    if (entry -> value == value) {
+      // Marcarlo como el más reciente
+      unlink_entry(cache, entry);
+      link_newest(cache, entry);
+      *is_new = false;
+      return entry;
+    }
+  }
+  // Reutilizar el menos reciente si el caché está lleno
+  cache_entry_t* entry = cache -> entry_count >= cache -> capacity
+                         ? evict_entry(cache) : NULL;
+  if (entry) {
+    memset(entry, 0, sizeof(cache_entry_t));
+  } else {
+    entry = (cache_entry_t*) arena_allocate(&cache -> arena,
+                                            sizeof(cache_entry_t));
+    ++cache -> entry_count;
+  }
+  // Agregar un resultado pendiente al inicio de la lista
+  if (cache -> entry_count > cache -> bucket_count) {
+    expand_buckets(cache);
+  }
+  bucket = hash_key(value, cache -> bucket_count);
+  entry -> value = value;
+  entry -> next = cache -> buckets[bucket];
+  cache -> buckets[bucket] = entry;
+  link_newest(cache, entry);
+  *is_new = true;
+  return entry;
+}
+
+cache_entry_t* evict_entry(result_cache_t* cache) {
+  cache_entry_t* entry = cache -> oldest;
+  // Saltar los resultados que se calculan o que otras entradas esperan
+  while (entry && (!entry -> is_ready || entry -> waiter_count > 0))
+    entry = entry -> newer;
+  if (!entry)
+    return NULL;
+  // Quitarlo de su lista, que solo se puede recorrer hacia adelante
+  cache_entry_t** link = &cache -> buckets[hash_key(entry -> value,
+                                                    cache -> bucket_count)];
+  while (*link != entry)
+    link = &(*link) -> next;
+  *link = entry -> next;
+  unlink_entry(cache, entry);
+  return entry;
+}
+
+void link_newest(result_cache_t* cache, cache_entry_t* entry) {
+  entry -> older = cache -> newest;
+  entry -> newer = NULL;
+  if (cache -> newest)
+    cache -> newest -> newer = entry;
+  else
+    cache -> oldest = entry;
+  cache -> newest = entry;
+}
+
+void unlink_entry(result_cache_t* cache, cache_entry_t* entry) {
+  if (entry -> older)
+    entry -> older -> newer = entry -> newer;
+  else
+    cache -> oldest = entry -> newer;
+  if (entry -> newer)
+    entry -> newer -> older = entry -> older;
+  else
+    cache -> newest = entry -> older;
+}
+
+void expand_buckets(result_cache_t* cache) {
+  uint32_t bucket_count = 2 * cache -> bucket_count;
+  cache_entry_t** buckets = (cache_entry_t**) calloc(bucket_count,
+                                                     sizeof(cache_entry_t*));
+  // Enlazar cada resultado en su lista de la nueva tabla
+  for (uint32_t bucket = 0; bucket < cache -> bucket_count; ++bucket) {
+    cache_entry_t* entry = cache -> buckets[bucket];
+    while (entry) {
+      cache_entry_t* next = entry -> next;
+      uint32_t position = hash_key(entry -> value, bucket_count);
+      entry -> next = buckets[position];
+      buckets[position] = entry;
+      entry = next;
+    }
+  }
+  free(cache -> buckets);
+  cache -> buckets = buckets;
+  cache -> bucket_count = bucket_count;
+}
+
+uint32_t hash_key(uint64_t value, uint32_t bucket_count) {
+  // Hash multiplicativo de Fibonacci sobre el valor
+  uint64_t key = value * 0x9E3779B97F4A7C15ull;
+  return (uint32_t) (key >> 32) & (bucket_count - 1);
+}
@@ -0,0 +1,141 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "arena.h"
+#include "goldbach.h"
+
+/// Cantidad inicial de listas del caché, se duplica al llenarse
+#define RESULT_CACHE_BUCKET_COUNT 1024
+/// Resultados que conserva el caché, al llenarse descarta el menos reciente
+#define RESULT_CACHE_CAPACITY (1u << 20)
+/// Versión del formato de los archivos de result_cache_save, se debe
+/// incrementar si cambia la forma de contar las sumas
+#define RESULT_CACHE_FILE_VERSION 1
+
+/**
+ * @brief Resultado guardado en el caché para un valor
+ * @details Mientras is_ready es falso el resultado se está calculando y las
+ *          demás entradas con el mismo valor esperan a que se publique. Los
+ *          resultados se enlazan además del más reciente al menos reciente
+ *          con newer y older, y mientras waiter_count no sea cero hay
+ *          entradas esperando el resultado, por lo que no se descarta.
+ */
+typedef struct cache_entry {
+  uint64_t value;
+  bool is_ready;
+  uint32_t waiter_count;
+  uint64_t count;
+  struct cache_entry* next;
+  struct cache_entry* newer;
+  struct cache_entry* older;
+} cache_entry_t;
+
+/**
+ * @brief Caché de resultados compartido por todos los hilos del solver
+ * @details Tabla hash con listas enlazadas cuya llave es el valor absoluto
+ *          normalizado de la entrada, de forma que "-000021", "-21" y "21"
+ *          comparten un solo cálculo, pues las sumas listadas no se guardan
+ *          sino que se enumeran al imprimirse. Los resultados se
+ *          reservan con el mutex bloqueado en arena, sin pasar por malloc,
+ *          y se liberan todos juntos. Para que la memoria de un servidor o
+ *          de un flujo largo no crezca con cada valor distinto, el caché
+ *          guarda a lo sumo capacity resultados: al llenarse reutiliza la
+ *          memoria del resultado usado hace más tiempo, el más cercano a
+ *          oldest que no se esté calculando ni esperando.
+ */
+typedef struct result_cache {
+  uint32_t capacity;
+  uint32_t bucket_count;
+  uint32_t entry_count;
+  cache_entry_t** buckets;
+  cache_entry_t* newest;
+  cache_entry_t* oldest;
+  arena_t arena;
+  pthread_mutex_t mutex;
+  pthread_cond_t is_ready;
+} result_cache_t;
+
+/**
+ * @brief Constructor, crea un caché vacío
+ * @code
+ *   result_cache_t* cache = result_cache_create();
+ * @endcode
+ * @return result_cache_t* estructura de datos
+ */
+result_cache_t* result_cache_create();
+
+/**
+ * @brief Destructor, libera los resultados y la memoria de la estructura
+ * @code
+ *   result_cache_destroy(cache);
+ * @endcode
+ * @param cache estructura de datos
+ */
+void result_cache_destroy(result_cache_t* cache);
+
+/**
+ * @brief Calcula la entrada o toma su resultado del caché
+ * @details Si el valor ya se calculó se comparte el resultado, si otro hilo
+ *          lo está calculando se espera a que termine y si no se calcula con
+ *          goldbach_run y se publica para las siguientes entradas. Las
+ *          entradas inválidas o menores o iguales a cinco no usan el caché.
+ * @code
+ *   result_cache_run(cache, goldbach, sieve, NULL);
+ * @endcode
+ * @param cache estructura de datos
+ * @param goldbach entrada a calcular
+ * @param sieve criba compartida con los números primos de la entrada
+ * @param table tabla compartida de cantidades de sumas, puede ser NULL
+ */
+void result_cache_run(result_cache_t* cache, goldbach_t* goldbach,
+                      sieve_t* sieve, count_table_t* table);
+
+/**
+ * @brief Carga las cantidades guardadas por result_cache_save
+ * @details Si el archivo no existe el caché queda igual, lo cual ocurre la
+ *          primera vez que se usa. Si el encabezado no coincide con el de
+ *          esta versión, el tamaño no corresponde a la cantidad de
+ *          resultados, la suma de verificación difiere o algún valor no se
+ *          admite, el archivo completo se rechaza sin cargar nada, pues una
+ *          cantidad corrupta se imprimiría como respuesta.
+ * @code
+ *   bool is_loaded = result_cache_load(cache, "goldbach.cache");
+ * @endcode
+ * @param cache estructura de datos
+ * @param path ruta del archivo binario escrito por result_cache_save
+ * @return
+ *   true: si el archivo no existe o se cargó completo
+ *   false: si el archivo existe pero se rechazó
+ */
+bool result_cache_load(result_cache_t* cache, const char* path);
+
+/**
+ * @brief Guarda las cantidades calculadas para reutilizarlas en otra corrida
+ * @details El archivo inicia con un encabezado que indica el formato, su
+ *          versión, el orden de los bytes, la cantidad de resultados y una
+ *          suma de verificación, seguido de una pareja valor y cantidad por
+ *          resultado, del menos reciente al más reciente
+ * @code
+ *   result_cache_save(cache, "goldbach.cache");
+ * @endcode
+ * @param cache estructura de datos
+ * @param path ruta del archivo binario a escribir
+ * @return
+ *   true: si se pudo escribir el archivo
+ *   false: si ocurrió un error al escribirlo
+ */
+bool result_cache_save(result_cache_t* cache, const char* path);
+
+#endif  // !RESULT_CACHE_H
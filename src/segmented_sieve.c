@@ -0,0 +1,53 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "segmented_sieve.h"
+
+void segmented_sieve_init(segmented_sieve_t* segment) {
+  assert(segment);
+  // Inicializar campos de la estructura
+  segment -> low = 0;
+  segment -> length = 0;
+  segment -> bits = (uint64_t*) malloc(SEGMENTED_SIEVE_LENGTH / 64
+                                       * sizeof(uint64_t));
+}
+
+void segmented_sieve_destroy(segmented_sieve_t* segment) {
+  assert(segment);
+  // Liberar la memoria utilizada por la estructura
+  segment -> length = 0;
+  free(segment -> bits);
+}
+
+void segmented_sieve_fill(segmented_sieve_t* segment, uint64_t low,
+                          uint32_t length, sieve_t* sieve) {
+  assert(segment);
+  assert(low % 2 == 1 && low > 1);
+  assert(length <= SEGMENTED_SIEVE_LENGTH);
+  uint64_t high = low + 2 * ((uint64_t) length - 1);
+  uint32_t word_count = (length + 63) / 64;
+  segment -> low = low;
+  segment -> length = length;
+  // Suponer que todos los impares del segmento son primos
+  memset(segment -> bits, 0xFF, word_count * sizeof(uint64_t));
+  if (length % 64)
+    segment -> bits[word_count - 1] = ((uint64_t) 1 << (length % 64)) - 1;
+  // Tachar los múltiplos impares de cada primo base hasta la raíz de high
+  sieve_iterator_t iterator;
+  sieve_iterator_init(&iterator, sieve, 3, sieve_get_limit(sieve));
+  for (uint64_t prime = sieve_iterator_next(&iterator); prime;
+       prime = sieve_iterator_next(&iterator)) {
+    if (prime * prime > high)
+      break;
+    uint64_t multiple = (low + prime - 1) / prime * prime;
+    if (multiple < prime * prime)
+      multiple = prime * prime;
+    if (multiple % 2 == 0)
+      multiple += prime;
+    for (uint64_t bit = (multiple - low) / 2; bit < length; bit += prime)
+      segment -> bits[bit >> 6] &= ~((uint64_t) 1 << (bit & 63));
+  }
+  // Los primos base deben alcanzar la raíz de high
+  assert((uint64_t) sieve_get_limit(sieve) * sieve_get_limit(sieve) >= high);
+}
@@ -0,0 +1,81 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef SEGMENTED_SIEVE_H
+#define SEGMENTED_SIEVE_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include "sieve.h"
+
+/// Cantidad de números impares que abarca cada segmento
+#define SEGMENTED_SIEVE_LENGTH (1u << 18)
+
+/**
+ * @brief Estructura de datos que marca los números primos impares de un
+ *        intervalo arbitrario de números de 64 bits
+ * @details Permite generar primos mucho mayores que el límite de la criba
+ *          compartida en memoria acotada: el intervalo se criba usando como
+ *          base los primos de la criba compartida, que deben llegar hasta la
+ *          raíz cuadrada del mayor número del intervalo. El bit i del campo
+ *          bits corresponde al número impar low + 2i.
+ */
+typedef struct segmented_sieve {
+  uint64_t low;
+  uint32_t length;
+  uint64_t* bits;
+} segmented_sieve_t;
+
+/**
+ * @brief Inicializador, reserva espacio para SEGMENTED_SIEVE_LENGTH números
+ * @code
+ *   segmented_sieve_init(&segment);
+ * @endcode
+ * @param segment segmento sin inicializar
+ */
+void segmented_sieve_init(segmented_sieve_t* segment);
+
+/**
+ * @brief Destructor, libera la memoria empleada por el segmento
+ * @code
+ *   segmented_sieve_destroy(&segment);
+ * @endcode
+ * @param segment segmento inicializado
+ */
+void segmented_sieve_destroy(segmented_sieve_t* segment);
+
+/**
+ * @brief Criba los números impares low, low + 2, ..., low + 2 (length - 1)
+ * @code
+ *   segmented_sieve_fill(&segment, 10000000001, 1024, sieve);
+ * @endcode
+ * @param segment segmento inicializado
+ * @param low primer número del intervalo, debe ser impar y mayor que uno
+ * @param length cantidad de impares, a lo sumo SEGMENTED_SIEVE_LENGTH
+ * @param sieve criba compartida con los primos hasta la raíz del intervalo
+ */
+void segmented_sieve_fill(segmented_sieve_t* segment, uint64_t low,
+                          uint32_t length, sieve_t* sieve);
+
+/**
+ * @brief Valida si el i-ésimo impar del segmento es primo
+ * @code
+ *   bool is_prime = segmented_sieve_is_prime(&segment, 0);
+ * @endcode
+ * @param segment segmento cribado
+ * @param index posición del impar dentro del segmento
+ * @return
+ *   true: si low + 2 index es primo
+ *   false: si low + 2 index no es primo
+ */
+static inline bool segmented_sieve_is_prime(segmented_sieve_t* segment,
+                                            uint32_t index) {
+  return (segment -> bits[index >> 6] >> (index & 63)) & 1;
+}
+
+#endif  // !SEGMENTED_SIEVE_H
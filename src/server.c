@@ -0,0 +1,296 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "server.h"
+
+/// Datos que recibe el hilo de una conexión
+typedef struct server_client {
+  server_t* server;
+  uint32_t slot;
+} server_client_t;
+
+/// Consulta que calcula un hilo del pool con server_compute
+typedef struct server_query {
+  engine_t* engine;
+  goldbach_t* goldbach;
+  sieve_t* sieve;
+} server_query_t;
+
+/**
+ * @brief Crea el socket de path y lo pone a escuchar
+ * @details Reemplaza un socket que ya existe solo si ningún servidor lo
+ *          atiende, y nunca otro tipo de archivo
+ * @code
+ *   server -> listener = server_listen(server);
+ * @endcode
+ * @param server estructura de datos
+ * @return int descriptor del socket, o -1 si no se pudo crear
+ */
+int server_listen(server_t* server);
+
+/**
+ * @brief Acepta conexiones y crea un hilo para cada una
+ * @details Espera a que haya un espacio libre en clients antes de aceptar
+ *          la siguiente conexión, las demás esperan en la cola del núcleo
+ * @code
+ *   pthread_create(&thread, NULL, server_accept, server);
+ * @endcode
+ * @param data estructura server_t
+ * @return void* NULL
+ */
+void* server_accept(void* data);
+
+/**
+ * @brief Atiende una conexión hasta que el cliente la cierre
+ * @code
+ *   pthread_create(&thread, &attributes, server_serve, client);
+ * @endcode
+ * @param data estructura server_client_t reservada con malloc, se libera
+ *        al iniciar
+ * @return void* NULL
+ */
+void* server_serve(void* data);
+
+/**
+ * @brief Responde cada valor que envía el cliente en el orden de llegada
+ * @details Vacía el búfer de salida cada vez que el cliente no tiene más
+ *          valores en camino, de forma que cada consulta recibe su respuesta
+ *          sin esperar a las siguientes
+ * @code
+ *   server_answer(server, stream);
+ * @endcode
+ * @param server estructura de datos
+ * @param stream socket de la conexión, sin búfer de stdio
+ */
+void server_answer(server_t* server, FILE* stream);
+
+/**
+ * @brief Calcula el valor de una consulta con el caché y la tabla de engine
+ * @details Es la tarea de pool_t, de modo que los valores enormes reparten
+ *          su primer primo entre los hilos desocupados del pool
+ * @code
+ *   pool_run(server -> pool, 1, server_compute, &query);
+ * @endcode
+ * @param data estructura server_query_t
+ * @param index número de la tarea, siempre cero
+ * @param thread número del hilo que la calcula
+ */
+void server_compute(void* data, uint32_t index, uint32_t thread);
+
+/**
+ * @brief Deja de aceptar conexiones y de leer de las conexiones abiertas
+ * @code
+ *   server_stop(server);
+ * @endcode
+ * @param server estructura de datos
+ */
+void server_stop(server_t* server);
+
+server_t* server_create(const char* path, engine_t* engine) {
+  assert(path);
+  assert(engine);
+  // Crear e inicializar campos de la estructura
+  server_t* server = (server_t*) calloc(1, sizeof(server_t));
+  server -> path = path;
+  server -> listener = -1;
+  for (uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; ++slot)
+    server -> clients[slot] = -1;
+  server -> engine = engine;
+  server -> pool = engine_get_pool(engine);
+  assert(server -> pool);
+  pthread_mutex_init(&server -> mutex, NULL);
+  pthread_cond_init(&server -> can_accept, NULL);
+  return server;
+}
+
+bool server_run(server_t* server) {
+  assert(server);
+  server -> listener = server_listen(server);
+  if (server -> listener < 0)
+    return false;
+  /* Bloquear las señales de terminación en todos los hilos, que heredan la
+     máscara, para esperarlas aquí con sigwait */
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+  // Un cliente que cierra sin leer su respuesta no debe terminar el proceso
+  signal(SIGPIPE, SIG_IGN);
+  pthread_t acceptor;
+  pthread_create(&acceptor, NULL, server_accept, server);
+  int signal_number = 0;
+  sigwait(&signals, &signal_number);
+  server_stop(server);
+  pthread_join(acceptor, NULL);
+  // Esperar a que cada conexión responda lo que ya recibió y termine
+  pthread_mutex_lock(&server -> mutex);
+  while (server -> client_count > 0)
+    pthread_cond_wait(&server -> can_accept, &server -> mutex);
+  pthread_mutex_unlock(&server -> mutex);
+  close(server -> listener);
+  unlink(server -> path);
+  pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+  return true;
+}
+
+int server_listen(server_t* server) {
+  assert(server);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(server -> path) >= sizeof(address.sun_path))
+    return -1;
+  strcpy(address.sun_path, server -> path);
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0)
+    return -1;
+  // Reemplazar un socket abandonado, pero no uno que otro servidor atiende
+  struct stat status;
+  if (stat(server -> path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool is_alive = probe >= 0 && connect(probe, (struct sockaddr*) &address,
+                                          sizeof(address)) == 0;
+    if (probe >= 0)
+      close(probe);
+    if (!is_alive)
+      unlink(server -> path);
+  }
+  if (bind(listener, (struct sockaddr*) &address, sizeof(address)) != 0 ||
+      listen(listener, SERVER_BACKLOG) != 0) {
+    close(listener);
+    return -1;
+  }
+  return listener;
+}
+
+void* server_accept(void* data) {
+  server_t* server = (server_t*) data;
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+  while (true) {
+    // Esperar un espacio libre antes de aceptar la siguiente conexión
+    pthread_mutex_lock(&server -> mutex);
+    while (server -> client_count == SERVER_MAX_CLIENTS &&
+           !server -> is_stopping)
+      pthread_cond_wait(&server -> can_accept, &server -> mutex);
+    bool is_stopping = server -> is_stopping;
+    pthread_mutex_unlock(&server -> mutex);
+    if (is_stopping)
+      break;
+    int descriptor = accept(server -> listener, NULL, NULL);
+    if (descriptor < 0)
+      continue;  // server_stop despierta a accept con un error
+    // Registrar la conexión para que server_stop pueda cerrarla
+    pthread_mutex_lock(&server -> mutex);
+    if (server -> is_stopping) {
+      pthread_mutex_unlock(&server -> mutex);
+      close(descriptor);
+      break;
+    }
+    uint32_t slot = 0;
+    while (server -> clients[slot] >= 0)
+      ++slot;
+    server -> clients[slot] = descriptor;
+    ++server -> client_count;
+    pthread_mutex_unlock(&server -> mutex);
+    server_client_t* client = (server_client_t*)
+        malloc(sizeof(server_client_t));
+    client -> server = server;
+    client -> slot = slot;
+    pthread_t thread;
+    if (pthread_create(&thread, &attributes, server_serve, client) != 0) {
+      // Sin hilo para la conexión se libera su espacio y se cierra
+      pthread_mutex_lock(&server -> mutex);
+      server -> clients[slot] = -1;
+      --server -> client_count;
+      pthread_mutex_unlock(&server -> mutex);
+      close(descriptor);
+      free(client);
+    }
+  }
+  pthread_attr_destroy(&attributes);
+  return NULL;
+}
+
+void* server_serve(void* data) {
+  server_client_t* client = (server_client_t*) data;
+  server_t* server = client -> server;
+  uint32_t slot = client -> slot;
+  free(client);
+  // El descriptor se registró antes de crear este hilo
+  int descriptor = server -> clients[slot];
+  FILE* stream = fdopen(descriptor, "r+");
+  if (stream) {
+    setvbuf(stream, NULL, _IONBF, 0);
+    server_answer(server, stream);
+  }
+  // Liberar el espacio antes de cerrar, para que server_stop no lo use
+  pthread_mutex_lock(&server -> mutex);
+  server -> clients[slot] = -1;
+  --server -> client_count;
+  pthread_cond_broadcast(&server -> can_accept);
+  pthread_mutex_unlock(&server -> mutex);
+  if (stream)
+    fclose(stream);
+  else
+    close(descriptor);
+  return NULL;
+}
+
+void server_answer(server_t* server, FILE* stream) {
+  assert(server);
+  reader_t reader;
+  writer_t writer;
+  const char* token = NULL;
+  uint32_t length = 0;
+  reader_init(&reader, stream);
+  writer_init(&writer, stream);
+  while (reader_next(&reader, &token, &length)) {
+    goldbach_t* goldbach = goldbach_create(token, length, NULL);
+    server_query_t query = {server -> engine, goldbach,
+                            engine_get_sieve(server -> engine, goldbach)};
+    /* Calcular en un hilo del pool e imprimir en el de la conexión, de forma
+       que escribir en el socket no ocupa un hilo de cálculo */
+    pool_run(server -> pool, 1, server_compute, &query);
+    goldbach_print(goldbach, query.sieve, &writer);
+    goldbach_destroy(goldbach);
+    // Entregar las respuestas antes de esperar más consultas
+    if (!reader_is_buffered(&reader))
+      writer_flush(&writer);
+  }
+  writer_destroy(&writer);
+  reader_destroy(&reader);
+}
+
+void server_compute(void* data, uint32_t index, uint32_t thread) {
+  (void) index;
+  (void) thread;
+  server_query_t* query = (server_query_t*) data;
+  result_cache_run(engine_get_cache(query -> engine), query -> goldbach,
+                   query -> sieve, engine_get_table(query -> engine));
+}
+
+void server_stop(server_t* server) {
+  assert(server);
+  pthread_mutex_lock(&server -> mutex);
+  server -> is_stopping = true;
+  // Despertar a accept y hacer que cada conexión lea el fin de su entrada
+  shutdown(server -> listener, SHUT_RDWR);
+  for (uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; ++slot) {
+    if (server -> clients[slot] >= 0)
+      shutdown(server -> clients[slot], SHUT_RD);
+  }
+  pthread_cond_broadcast(&server -> can_accept);
+  pthread_mutex_unlock(&server -> mutex);
+}
+
+void server_destroy(server_t* server) {
+  assert(server);
+  // Liberar memoria empleada por la estructura, las cribas son de engine
+  pthread_mutex_destroy(&server -> mutex);
+  pthread_cond_destroy(&server -> can_accept);
+  free(server);
+}
@@ -0,0 +1,101 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef SERVER_H
+#define SERVER_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "sieve.h"
+#include "engine_internal.h"
+#include "goldbach.h"
+#include "pool.h"
+#include "reader.h"
+#include "result_cache.h"
+#include "writer.h"
+
+/// Conexiones que el servidor atiende a la vez, las demás esperan
+#define SERVER_MAX_CLIENTS 1024
+/// Conexiones pendientes que el núcleo encola antes de aceptarlas
+#define SERVER_BACKLOG 128
+
+/**
+ * @brief Estructura de datos que responde consultas por un socket de dominio
+ *        Unix sin terminar entre ellas
+ * @details Cada conexión envía valores separados por espacios en blanco,
+ *          normalmente uno por línea, y recibe cada resultado en el formato
+ *          de goldbach_print en el mismo orden. Las cribas, la tabla y el
+ *          caché de resultados de engine permanecen en memoria entre
+ *          consultas y conexiones, por lo que una consulta repetida o
+ *          pequeña no vuelve a generar primos. Cada conexión tiene un hilo
+ *          que lee y escribe en el socket, pero el cálculo de cada valor se
+ *          hace en un hilo del pool de engine, de forma que a lo sumo tantos
+ *          valores como hilos tiene el pool se calculan a la vez sin
+ *          importar cuántos clientes estén conectados. La respuesta se
+ *          escribe en el hilo de la conexión, sin ocupar un hilo del pool
+ *          mientras el cliente la lee.
+ */
+typedef struct server {
+  const char* path;
+  int listener;
+  bool is_stopping;
+  uint32_t client_count;
+  int clients[SERVER_MAX_CLIENTS];
+  engine_t* engine;
+  pool_t* pool;
+  pthread_mutex_t mutex;
+  pthread_cond_t can_accept;
+} server_t;
+
+/**
+ * @brief Constructor, inicializa los campos de la estructura
+ * @code
+ *   server_t* server = server_create("/tmp/goldbach.sock", engine);
+ * @endcode
+ * @param path ruta del socket, debe existir hasta que se destruya la
+ *        estructura
+ * @param engine contexto de cálculo compartido creado con un pool, cuyos
+ *        hilos calculan los valores, debe existir hasta que se destruya la
+ *        estructura
+ * @return server_t* estructura de datos
+ */
+server_t* server_create(const char* path, engine_t* engine);
+
+/**
+ * @brief Atiende conexiones hasta recibir SIGINT o SIGTERM
+ * @details Si path es un socket abandonado por otra corrida lo reemplaza.
+ *          Al detenerse deja de aceptar conexiones, termina de responder los
+ *          valores que ya recibió cada cliente, cierra las conexiones y
+ *          elimina el socket.
+ * @code
+ *   server_run(server);
+ * @endcode
+ * @param server estructura de datos
+ * @return
+ *   true: si se atendieron conexiones hasta recibir la señal
+ *   false: si no se pudo crear el socket
+ */
+bool server_run(server_t* server);
+
+/**
+ * @brief Destructor, libera la memoria de la estructura
+ * @code
+ *   server_destroy(server);
+ * @endcode
+ * @param server estructura de datos
+ */
+void server_destroy(server_t* server);
+
+#endif  // !SERVER_H
@@ -0,0 +1,560 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "sieve.h"
+
+/// Firma de las versiones de count_common_bits
+typedef uint64_t (*common_bits_t)(const uint64_t*, const uint8_t*,
+                                  const uint64_t*, uint64_t);
+
+/**
+ * @brief Criba la rueda por bloques de SIEVE_BLOCK_SIZE bytes
+ * @details Cada primo base p >= 7 tacha sus múltiplos p * q con q >= p
+ *          coprimo con 30. Para cada uno de los ocho residuos de q, el byte
+ *          de p * q avanza p posiciones cada vez que q aumenta en 30 y su
+ *          bit no cambia, por lo que se guarda el siguiente byte de cada
+ *          residuo entre un bloque y el siguiente.
+ * @code
+ *   fill_wheel(sieve);
+ * @endcode
+ * @param sieve estructura de datos con limit y word_count asignados
+ */
+void fill_wheel(sieve_t* sieve);
+
+/**
+ * @brief Retorna la máscara de los bits de la palabra de number cuyos
+ *        números son menores que number
+ * @code
+ *   uint64_t mask = wheel_mask(30);
+ *   //Retorna: 0xFF, los bits de 1 a 29
+ * @endcode
+ * @param number número cuya palabra es number / SIEVE_WORD_SPAN
+ * @return uint64_t máscara de bits
+ */
+uint64_t wheel_mask(uint64_t number);
+
+/**
+ * @brief Calcula base elevado a exponent módulo modulus sin desbordarse
+ * @code
+ *   uint64_t value = power_mod_64(3, 4, 7);
+ *   //Retorna: 4
+ * @endcode
+ * @param base base de la potencia
+ * @param exponent exponente de la potencia
+ * @param modulus módulo
+ * @return uint64_t resultado de la potencia
+ */
+uint64_t power_mod_64(uint64_t base, uint64_t exponent, uint64_t modulus);
+
+/**
+ * @brief Invierte el orden de los bits de word
+ * @code
+ *   uint64_t reversed = reverse_bits(1);
+ *   //Retorna: 2^63
+ * @endcode
+ * @param word palabra a invertir
+ * @return uint64_t palabra con el bit i en la posición 63 - i
+ */
+uint64_t reverse_bits(uint64_t word);
+
+/**
+ * @brief Reordena los bits de cada byte de word con una matriz de GF(2)
+ * @details Emula la instrucción gf2p8affineqb: el bit i de cada byte del
+ *          resultado es el bit s del mismo byte de word si el byte 7 - i de
+ *          matrix es 2^s, o cero si ese byte es cero
+ * @code
+ *   uint64_t permuted = permute_bits(0x01, 0x0200000000000000);
+ *   //Retorna: 0x02
+ * @endcode
+ * @param word palabra a reordenar
+ * @param matrix matriz con a lo sumo un bit encendido por byte
+ * @return uint64_t palabra reordenada
+ */
+uint64_t permute_bits(uint64_t word, uint64_t matrix);
+
+/**
+ * @brief Retorna los bits de los compañeros de una palabra de la rueda
+ * @code
+ *   uint64_t partners = read_partners(right + 8 * word, matrices);
+ * @endcode
+ * @param right bytes de reversed_bits alineados con la palabra
+ * @param matrices matrices de los bits que toman su compañero del mismo
+ *        byte y del byte siguiente de right
+ * @return uint64_t palabra con el compañero de cada bit en su posición
+ */
+uint64_t read_partners(const uint8_t* right, const uint64_t* matrices);
+
+/**
+ * @brief Cuenta los bits encendidos de left[k] AND los compañeros de k
+ * @details Suma para cada k < count los bits encendidos de left[k] y
+ *          read_partners(right + 8k, matrices). Se declara como ifunc, de
+ *          forma que el cargador elige con choose_common_bits la versión
+ *          para AVX-512, para AVX2 o la portable según el procesador.
+ * @code
+ *   uint64_t count = count_common_bits(left, right, matrices, 1024);
+ * @endcode
+ * @param left primer arreglo de palabras
+ * @param right bytes de reversed_bits, con 8 * count + 9 elementos
+ * @param matrices matrices de read_partners
+ * @param count cantidad de palabras de left
+ * @return uint64_t cantidad de bits encendidos en común
+ */
+uint64_t count_common_bits(const uint64_t* left, const uint8_t* right,
+                           const uint64_t* matrices, uint64_t count)
+  __attribute__((ifunc("choose_common_bits")));
+
+/**
+ * @brief Versión de count_common_bits con instrucciones de AVX-512 y GFNI
+ * @details Procesa ocho palabras por iteración, reordena los bits con la
+ *          instrucción gf2p8affineqb y los cuenta con vpopcntq. Las palabras
+ *          sobrantes se cargan con máscara en una última iteración.
+ */
+__attribute__((target("avx512f,avx512bw,avx512vpopcntdq,gfni")))
+uint64_t count_common_bits_avx512(const uint64_t* left, const uint8_t* right,
+                                  const uint64_t* matrices, uint64_t count);
+
+/**
+ * @brief Versión de count_common_bits con instrucciones de AVX2
+ * @details Procesa cuatro palabras por iteración. Como reordenar bits es
+ *          lineal, cada mitad de byte se reordena con una tabla de 16
+ *          entradas y vpshufb, y los bits se cuentan de la misma forma.
+ */
+__attribute__((target("avx2")))
+uint64_t count_common_bits_avx2(const uint64_t* left, const uint8_t* right,
+                                const uint64_t* matrices, uint64_t count);
+
+/**
+ * @brief Versión portable de count_common_bits, una palabra por iteración
+ */
+uint64_t count_common_bits_default(const uint64_t* left, const uint8_t* right,
+                                   const uint64_t* matrices, uint64_t count);
+
+/**
+ * @brief Elige la versión de count_common_bits según el procesador
+ * @details La invoca el cargador una sola vez al iniciar el programa, antes
+ *          de inicializar los sanitizadores, por lo que no se instrumenta
+ * @return common_bits_t dirección de la versión elegida
+ */
+common_bits_t choose_common_bits(void)
+  __attribute__((no_sanitize("address", "thread", "undefined")));
+
+sieve_t* sieve_create(uint32_t limit) {
+  assert(limit <= SIEVE_MAX_LIMIT);
+  // Crear e inicializar campos de la estructura
+  sieve_t* sieve = (sieve_t*) calloc(1, sizeof(sieve_t));
+  uint64_t word_count = ((uint64_t) limit + 1) / SIEVE_WORD_SPAN + 1;
+  sieve -> limit = limit;
+  sieve -> word_count = word_count;
+  sieve -> bits = (uint64_t*) malloc(word_count * sizeof(uint64_t));
+  // Tachar los múltiplos de los primos base, el uno y los mayores que limit
+  fill_wheel(sieve);
+  sieve -> bits[0] &= ~(uint64_t) 1;
+  sieve -> bits[((uint64_t) limit + 1) / SIEVE_WORD_SPAN] &=
+      wheel_mask((uint64_t) limit + 1);
+  /* Invertir la rueda para contar parejas, con dos palabras extra en cero
+     para que las ventanas no lean fuera del arreglo */
+  sieve -> reversed_bits = (uint64_t*) malloc((word_count + 2)
+                                              * sizeof(uint64_t));
+  for (uint64_t word = 0; word < word_count; ++word) {
+    sieve -> reversed_bits[word] = reverse_bits(sieve -> bits[word_count - 1
+                                                              - word]);
+  }
+  sieve -> reversed_bits[word_count] = 0;
+  sieve -> reversed_bits[word_count + 1] = 0;
+  // Acumular la cantidad de primos antes de cada grupo de palabras
+  uint64_t group_count = word_count / SIEVE_COUNT_STRIDE + 1;
+  sieve -> prime_counts = (uint32_t*) malloc(group_count * sizeof(uint32_t));
+  uint32_t count = 0;
+  for (uint64_t word = 0; word < word_count; ++word) {
+    if (word % SIEVE_COUNT_STRIDE == 0)
+      sieve -> prime_counts[word / SIEVE_COUNT_STRIDE] = count;
+    count += (uint32_t) __builtin_popcountll(sieve -> bits[word]);
+  }
+  return sieve;
+}
+
+void sieve_destroy(sieve_t* sieve) {
+  assert(sieve);
+  // Liberar memoria empleada por la estructura
+  free(sieve -> bits);
+  free(sieve -> reversed_bits);
+  free(sieve -> prime_counts);
+  free(sieve);
+}
+
+void fill_wheel(sieve_t* sieve) {
+  uint8_t* bytes = (uint8_t*) sieve -> bits;
+  uint64_t byte_count = 8 * sieve -> word_count;
+  uint32_t root = 1;
+  while ((uint64_t) (root + 1) * (root + 1) <= sieve -> limit)
+    ++root;
+  // Calcular los primos base hasta la raíz de limit con una criba simple
+  bool* is_composite = (bool*) calloc(root + 1, sizeof(bool));
+  uint32_t* primes = (uint32_t*) malloc((root + 1) * sizeof(uint32_t));
+  uint32_t prime_count = 0;
+  for (uint32_t odd = 3; odd <= root; odd += 2) {
+    if (!is_composite[odd]) {
+      for (uint32_t multiple = odd * odd; multiple <= root;
+           multiple += 2 * odd)
+        is_composite[multiple] = true;
+      if (odd >= 7)
+        primes[prime_count++] = odd;
+    }
+  }
+  /* Ubicar el primer múltiplo p * q con q >= p de cada residuo de q, cuyo
+     byte avanza p posiciones por cada vuelta de la rueda */
+  uint32_t* next = (uint32_t*) malloc(8 * (uint64_t) prime_count
+                                      * sizeof(uint32_t));
+  uint8_t* masks = (uint8_t*) malloc(8 * (uint64_t) prime_count);
+  for (uint32_t index = 0; index < prime_count; ++index) {
+    uint64_t prime = primes[index];
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+      uint64_t factor = prime + (SIEVE_WHEEL_RESIDUES[bit] + 30
+                                 - prime % 30) % 30;
+      next[8 * index + bit] = (uint32_t) (prime * factor / 30);
+      masks[8 * index + bit] = SIEVE_WHEEL_MASKS[prime * factor % 30];
+    }
+  }
+  // Cribar cada bloque con todos los primos base mientras está en caché
+  for (uint64_t begin = 0; begin < byte_count; begin += SIEVE_BLOCK_SIZE) {
+    uint64_t end = begin + SIEVE_BLOCK_SIZE < byte_count
+                   ? begin + SIEVE_BLOCK_SIZE : byte_count;
+    memset(bytes + begin, 0xFF, end - begin);
+    for (uint32_t index = 0; index < prime_count; ++index) {
+      for (uint32_t bit = 0; bit < 8; ++bit) {
+        uint64_t position = next[8 * index + bit];
+        uint8_t mask = (uint8_t) ~masks[8 * index + bit];
+        for (; position < end; position += primes[index])
+          bytes[position] &= mask;
+        next[8 * index + bit] = (uint32_t) position;
+      }
+    }
+  }
+  free(is_composite);
+  free(primes);
+  free(next);
+  free(masks);
+}
+
+uint64_t wheel_mask(uint64_t number) {
+  // Bits de la rueda con residuo menor que cada residuo módulo 30
+  static const uint8_t lower_bits[30] = {0, 0, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3,
+                                         7, 7, 15, 15, 15, 15, 31, 31, 63,
+                                         63, 63, 63, 127, 127, 127, 127, 127,
+                                         127};
+  uint32_t offset = number % SIEVE_WORD_SPAN;
+  uint32_t byte = offset / 30;
+  // Bits de los bytes anteriores y de los residuos menores en el byte
+  return (((uint64_t) 1 << (8 * byte)) - 1) |
+         ((uint64_t) lower_bits[offset % 30] << (8 * byte));
+}
+
+uint32_t sieve_count_primes(sieve_t* sieve, uint32_t number) {
+  assert(sieve);
+  if (number > sieve -> limit)
+    number = sieve -> limit;
+  // Los primos 2, 3 y 5 no están en la rueda
+  uint32_t count = (number >= 2) + (number >= 3) + (number >= 5);
+  uint64_t word = ((uint64_t) number + 1) / SIEVE_WORD_SPAN;
+  uint64_t group = word / SIEVE_COUNT_STRIDE;
+  count += sieve -> prime_counts[group];
+  for (uint64_t index = group * SIEVE_COUNT_STRIDE; index < word; ++index)
+    count += (uint32_t) __builtin_popcountll(sieve -> bits[index]);
+  return count + (uint32_t) __builtin_popcountll(sieve -> bits[word] &
+      wheel_mask((uint64_t) number + 1));
+}
+
+uint64_t sieve_count_pairs(sieve_t* sieve, uint32_t number, uint32_t minimum,
+                           uint32_t maximum) {
+  assert(sieve);
+  assert(number % 2 == 0 && number <= sieve -> limit);
+  // Las parejas con 2, 3 o 5 no están en la rueda y se validan aparte
+  uint64_t count = minimum <= 2 && maximum >= 2 && number == 4;
+  for (uint32_t prime = 3; prime <= 5; prime += 2) {
+    if (minimum <= prime && prime <= maximum &&
+        sieve_is_prime(sieve, number - prime))
+      ++count;
+  }
+  uint64_t first = minimum < 7 ? 7 : minimum;
+  uint64_t end = (uint64_t) maximum + 1;
+  if (first >= end)
+    return count;
+  /* El compañero de p es el número p + distance de reversed_bits, cuyo
+     residuo depende solo del residuo de p y que está en el mismo byte que
+     p o en el siguiente de una ventana que inicia distance / 30 bytes
+     después */
+  uint64_t distance = 30 * 8 * sieve -> word_count - number;
+  uint64_t matrices[2] = {0, 0};
+  for (uint32_t bit = 0; bit < 8; ++bit) {
+    uint32_t sum = SIEVE_WHEEL_RESIDUES[bit] + distance % 30;
+    uint32_t carry = sum >= 30;
+    matrices[carry] |= (uint64_t) SIEVE_WHEEL_MASKS[sum - 30 * carry]
+                       << (8 * (7 - bit));
+  }
+  const uint8_t* right = (const uint8_t*) sieve -> reversed_bits
+                         + distance / 30;
+  uint64_t first_word = first / SIEVE_WORD_SPAN;
+  uint64_t last_word = end / SIEVE_WORD_SPAN;
+  uint64_t first_mask = ~wheel_mask(first);
+  uint64_t last_mask = wheel_mask(end);
+  /* Contar las palabras de los extremos con una copia con máscara y el resto
+     directamente con el kernel */
+  uint64_t edge = sieve -> bits[first_word] & first_mask;
+  if (first_word == last_word)
+    edge &= last_mask;
+  count += count_common_bits(&edge, right + 8 * first_word, matrices, 1);
+  if (first_word < last_word) {
+    count += count_common_bits(sieve -> bits + first_word + 1,
+                               right + 8 * (first_word + 1), matrices,
+                               last_word - first_word - 1);
+    edge = sieve -> bits[last_word] & last_mask;
+    count += count_common_bits(&edge, right + 8 * last_word, matrices, 1);
+  }
+  return count;
+}
+
+void sieve_iterator_init(sieve_iterator_t* iterator, sieve_t* sieve,
+                         uint64_t minimum, uint64_t maximum) {
+  assert(iterator);
+  assert(sieve);
+  assert(maximum <= sieve -> limit);
+  // Los primos 2, 3 y 5 se entregan primero como posiciones de bits
+  iterator -> small_primes = 0;
+  if (minimum <= 5 && minimum <= maximum) {
+    uint32_t top = maximum < 5 ? (uint32_t) maximum : 5;
+    iterator -> small_primes = 0x2Cu & ((2u << top) - 1)
+                               & ~((1u << minimum) - 1);
+  }
+  // Tomar la palabra de first, sin los bits menores que first
+  uint64_t first = minimum < 7 ? 7 : minimum;
+  uint64_t end = maximum + 1;
+  iterator -> words = sieve -> bits;
+  iterator -> word = first < end ? first / SIEVE_WORD_SPAN : 0;
+  iterator -> last_word = first < end ? end / SIEVE_WORD_SPAN : 0;
+  iterator -> last_mask = wheel_mask(end);
+  iterator -> bits = first < end ? sieve -> bits[iterator -> word] &
+                                   ~wheel_mask(first) : 0;
+  if (iterator -> word == iterator -> last_word)
+    iterator -> bits &= iterator -> last_mask;
+}
+
+uint64_t reverse_bits(uint64_t word) {
+  // Intercambiar bits, parejas y nibbles vecinos, y luego los bytes
+  word = ((word >> 1) & 0x5555555555555555ull) |
+         ((word & 0x5555555555555555ull) << 1);
+  word = ((word >> 2) & 0x3333333333333333ull) |
+         ((word & 0x3333333333333333ull) << 2);
+  word = ((word >> 4) & 0x0F0F0F0F0F0F0F0Full) |
+         ((word & 0x0F0F0F0F0F0F0F0Full) << 4);
+  return __builtin_bswap64(word);
+}
+
+uint64_t permute_bits(uint64_t word, uint64_t matrix) {
+  uint64_t result = 0;
+  // Llevar el bit s de cada byte al bit i cuando el byte 7 - i es 2^s
+  for (uint32_t bit = 0; bit < 8; ++bit) {
+    uint32_t row = (matrix >> (8 * (7 - bit))) & 0xFF;
+    if (row) {
+      result |= ((word >> __builtin_ctz(row)) & 0x0101010101010101ull)
+                << bit;
+    }
+  }
+  return result;
+}
+
+uint64_t read_partners(const uint8_t* right, const uint64_t* matrices) {
+  uint64_t same = 0;
+  uint64_t next = 0;
+  memcpy(&same, right, sizeof(uint64_t));
+  memcpy(&next, right + 1, sizeof(uint64_t));
+  return permute_bits(same, matrices[0]) | permute_bits(next, matrices[1]);
+}
+
+uint64_t count_common_bits_avx512(const uint64_t* left, const uint8_t* right,
+                                  const uint64_t* matrices, uint64_t count) {
+  __m512i same_matrix = _mm512_set1_epi64((int64_t) matrices[0]);
+  __m512i next_matrix = _mm512_set1_epi64((int64_t) matrices[1]);
+  __m512i total = _mm512_setzero_si512();
+  uint64_t index = 0;
+  for (; index + 8 <= count; index += 8) {
+    __m512i same = _mm512_loadu_si512(right + 8 * index);
+    __m512i next = _mm512_loadu_si512(right + 8 * index + 1);
+    __m512i window = _mm512_or_si512(
+        _mm512_gf2p8affine_epi64_epi8(same, same_matrix, 0),
+        _mm512_gf2p8affine_epi64_epi8(next, next_matrix, 0));
+    __m512i common = _mm512_and_si512(_mm512_loadu_si512(left + index),
+                                      window);
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(common));
+  }
+  // Las palabras sobrantes se cargan con máscara, sin leer fuera del arreglo
+  if (index < count) {
+    __mmask8 words = (__mmask8) ((1u << (count - index)) - 1);
+    __mmask64 bytes = ((uint64_t) 1 << (8 * (count - index))) - 1;
+    __m512i same = _mm512_maskz_loadu_epi8(bytes, right + 8 * index);
+    __m512i next = _mm512_maskz_loadu_epi8(bytes, right + 8 * index + 1);
+    __m512i window = _mm512_or_si512(
+        _mm512_gf2p8affine_epi64_epi8(same, same_matrix, 0),
+        _mm512_gf2p8affine_epi64_epi8(next, next_matrix, 0));
+    __m512i common = _mm512_and_si512(
+        _mm512_maskz_loadu_epi64(words, left + index), window);
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(common));
+  }
+  return _mm512_reduce_add_epi64(total);
+}
+
+uint64_t count_common_bits_avx2(const uint64_t* left, const uint8_t* right,
+                                const uint64_t* matrices, uint64_t count) {
+  /* Construir las tablas de cada mitad de byte a partir de la imagen de
+     cada bit, pues la imagen de un valor es el OR de las de sus bits */
+  uint8_t tables[4][16];
+  for (uint32_t table = 0; table < 4; ++table) {
+    tables[table][0] = 0;
+    for (uint32_t value = 1; value < 16; ++value) {
+      uint32_t low_bit = value & -value;
+      tables[table][value] = tables[table][value & (value - 1)] |
+          (uint8_t) permute_bits(low_bit << (4 * (table % 2)),
+                                 matrices[table / 2]);
+    }
+  }
+  __m256i lookups[4];
+  for (uint32_t table = 0; table < 4; ++table) {
+    lookups[table] = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i*) tables[table]));
+  }
+  // Cantidad de bits encendidos de cada valor de 0 a 15
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3,
+      2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+  __m256i total = _mm256_setzero_si256();
+  uint64_t index = 0;
+  for (; index + 4 <= count; index += 4) {
+    __m256i same = _mm256_loadu_si256((const __m256i*) (right + 8 * index));
+    __m256i next = _mm256_loadu_si256((const __m256i*) (right + 8 * index
+                                                        + 1));
+    // Reordenar cada mitad de byte con su tabla
+    __m256i window = _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_shuffle_epi8(lookups[0], _mm256_and_si256(same,
+                                                             nibble_mask)),
+            _mm256_shuffle_epi8(lookups[1], _mm256_and_si256(
+                _mm256_srli_epi16(same, 4), nibble_mask))),
+        _mm256_or_si256(
+            _mm256_shuffle_epi8(lookups[2], _mm256_and_si256(next,
+                                                             nibble_mask)),
+            _mm256_shuffle_epi8(lookups[3], _mm256_and_si256(
+                _mm256_srli_epi16(next, 4), nibble_mask))));
+    __m256i common = _mm256_and_si256(
+        _mm256_loadu_si256((const __m256i*) (left + index)), window);
+    // Contar cada mitad de byte con la tabla y sumar los bytes por palabra
+    __m256i bytes = _mm256_add_epi8(
+        _mm256_shuffle_epi8(lookup, _mm256_and_si256(common, nibble_mask)),
+        _mm256_shuffle_epi8(lookup, _mm256_and_si256(
+            _mm256_srli_epi16(common, 4), nibble_mask)));
+    total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes,
+                                                    _mm256_setzero_si256()));
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i*) lanes, total);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+         count_common_bits_default(left + index, right + 8 * index, matrices,
+                                   count - index);
+}
+
+uint64_t count_common_bits_default(const uint64_t* left, const uint8_t* right,
+                                   const uint64_t* matrices, uint64_t count) {
+  uint64_t total = 0;
+  for (uint64_t index = 0; index < count; ++index) {
+    total += __builtin_popcountll(left[index] &
+                                  read_partners(right + 8 * index, matrices));
+  }
+  return total;
+}
+
+common_bits_t choose_common_bits(void) {
+  // Preferir la versión más ancha que soporte el procesador
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512vpopcntdq") &&
+      __builtin_cpu_supports("gfni"))
+    return count_common_bits_avx512;
+  if (__builtin_cpu_supports("avx2"))
+    return count_common_bits_avx2;
+  return count_common_bits_default;
+}
+
+uint64_t sieve_next_prime(sieve_t* sieve, uint64_t number) {
+  assert(sieve);
+  if (number < 5)
+    return number < 2 ? 2 : number < 3 ? 3 : 5;
+  // Buscar el siguiente bit encendido de la rueda si number no la excede
+  if (number < sieve -> limit) {
+    uint64_t word = (number + 1) / SIEVE_WORD_SPAN;
+    uint64_t bits = sieve -> bits[word] & ~wheel_mask(number + 1);
+    while (!bits && ++word < sieve -> word_count)
+      bits = sieve -> bits[word];
+    if (bits) {
+      uint32_t bit = (uint32_t) __builtin_ctzll(bits);
+      return SIEVE_WORD_SPAN * word + 30 * (bit / 8) +
+             SIEVE_WHEEL_RESIDUES[bit % 8];
+    }
+  }
+  // Probar individualmente los impares siguientes
+  uint64_t candidate = (number + 1) | 1;
+  while (!sieve_is_prime(sieve, candidate))
+    candidate += 2;
+  return candidate;
+}
+
+bool sieve_miller_rabin(uint64_t number) {
+  const uint64_t witnesses[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+  const uint32_t witness_count = sizeof(witnesses) / sizeof(witnesses[0]);
+  // Descartar los múltiplos de los testigos
+  if (number < 2)
+    return false;
+  for (uint32_t index = 0; index < witness_count; ++index) {
+    if (number % witnesses[index] == 0)
+      return number == witnesses[index];
+  }
+  // Escribir number - 1 como odd * 2^shift
+  uint64_t odd = number - 1;
+  uint32_t shift = 0;
+  while (odd % 2 == 0) {
+    odd /= 2;
+    ++shift;
+  }
+  // Buscar un testigo de que number es compuesto
+  for (uint32_t index = 0; index < witness_count; ++index) {
+    uint64_t value = power_mod_64(witnesses[index], odd, number);
+    if (value == 1 || value == number - 1)
+      continue;
+    bool is_composite = true;
+    for (uint32_t square = 1; square < shift && is_composite; ++square) {
+      value = (unsigned __int128) value * value % number;
+      if (value == number - 1)
+        is_composite = false;
+    }
+    if (is_composite)
+      return false;
+  }
+  return true;
+}
+
+uint64_t power_mod_64(uint64_t base, uint64_t exponent, uint64_t modulus) {
+  uint64_t result = 1;
+  base %= modulus;
+  // Exponenciación binaria con productos de 128 bits
+  while (exponent) {
+    if (exponent & 1)
+      result = (unsigned __int128) result * base % modulus;
+    base = (unsigned __int128) base * base % modulus;
+    exponent >>= 1;
+  }
+  return result;
+}
+
+uint32_t sieve_get_limit(sieve_t* sieve) {
+  assert(sieve);
+  return sieve -> limit;  // Retornar campo limit de sieve
+}
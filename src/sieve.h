@@ -0,0 +1,249 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef SIEVE_H
+#define SIEVE_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <immintrin.h>
+
+/// Mayor límite de la criba compartida, los valores mayores usan cribas
+/// segmentadas y la prueba de Miller-Rabin
+#define SIEVE_MAX_LIMIT (1u << 30)
+
+/// Cantidad de números que abarca cada palabra de la rueda
+#define SIEVE_WORD_SPAN 240
+
+/// Palabras de la rueda por cada cuenta acumulada de primos
+#define SIEVE_COUNT_STRIDE 8
+
+/// Bytes de la rueda que se criban a la vez, de forma que quepan en caché
+#define SIEVE_BLOCK_SIZE (1u << 18)
+
+/// Residuos módulo 30 de los números coprimos con 2, 3 y 5, el bit i de cada
+/// byte de la rueda corresponde al residuo SIEVE_WHEEL_RESIDUES[i]
+static const uint8_t SIEVE_WHEEL_RESIDUES[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+
+/// Bit de la rueda de cada residuo módulo 30, cero si no es coprimo con 30
+static const uint8_t SIEVE_WHEEL_MASKS[30] = {0, 1, 0, 0, 0, 0, 0, 2, 0, 0,
+                                              0, 4, 0, 8, 0, 0, 0, 16, 0, 32,
+                                              0, 0, 0, 64, 0, 0, 0, 0, 0, 128};
+
+/**
+ * @brief Estructura de datos que almacena los números primos desde dos
+ *        hasta un límite dado, calculados con la Criba de Eratóstenes
+ * @details Se construye una única vez por lote y es compartida en modo de
+ *          solo lectura por todos los objetos goldbach_t, de forma que
+ *          ningún hilo vuelve a calcular ni copia los números primos. El
+ *          campo bits es una rueda módulo 30: el byte k guarda un bit por
+ *          cada número 30k + r con r coprimo con 30, es decir ocho bits por
+ *          cada treinta números, y los primos 2, 3 y 5 se tratan aparte.
+ *          reversed_bits es la misma rueda invertida, de forma que los
+ *          compañeros n - p de los primos p quedan en orden ascendente, y
+ *          prime_counts guarda la cantidad de primos antes de cada grupo de
+ *          SIEVE_COUNT_STRIDE palabras.
+ */
+typedef struct sieve {
+  uint32_t limit;
+  uint64_t word_count;
+  uint64_t* bits;
+  uint64_t* reversed_bits;
+  uint32_t* prime_counts;
+} sieve_t;
+
+/**
+ * @brief Recorrido en orden ascendente de los primos de la criba dentro de
+ *        un intervalo
+ * @details Se inicializa con sieve_iterator_init y cada primo se obtiene
+ *          con sieve_iterator_next. small_primes guarda como máscara de
+ *          bits los primos 2, 3 y 5 pendientes, que no están en la rueda.
+ */
+typedef struct sieve_iterator {
+  const uint64_t* words;
+  uint64_t word;
+  uint64_t last_word;
+  uint64_t last_mask;
+  uint64_t bits;
+  uint32_t small_primes;
+} sieve_iterator_t;
+
+/**
+ * @brief Constructor, calcula todos los números primos hasta limit
+ * @code
+ *   sieve_t* sieve = sieve_create(10000000);
+ * @endcode
+ * @param limit número hasta el cual se generan primos
+ * @return sieve_t* estructura de datos
+ */
+sieve_t* sieve_create(uint32_t limit);
+
+/**
+ * @brief Destructor, libera la memoria de la estructura
+ * @code
+ *   sieve_destroy(sieve);
+ * @endcode
+ * @param sieve estructura de datos
+ */
+void sieve_destroy(sieve_t* sieve);
+
+/**
+ * @brief Retorna la cantidad de primos menores o iguales a number
+ * @details Suma la cuenta acumulada del grupo de palabras de number y los
+ *          bits encendidos de a lo sumo SIEVE_COUNT_STRIDE palabras, por lo
+ *          que no depende del tamaño de la criba
+ * @code
+ *   uint32_t count = sieve_count_primes(sieve, 10);
+ *   //Retorna: 4 pues los primos son [2, 3, 5, 7]
+ * @endcode
+ * @param sieve estructura de datos
+ * @param number cota superior de los primos a contar
+ * @return uint32_t cantidad de primos menores o iguales a number
+ */
+uint32_t sieve_count_primes(sieve_t* sieve, uint32_t number);
+
+/**
+ * @brief Cuenta los primos p entre minimum y maximum tales que number - p
+ *        también es primo
+ * @details reversed_bits representa al número 30 * 8 * word_count - q en
+ *          la posición del número q, por lo que el compañero number - p de
+ *          p queda en el número p + distance de reversed_bits, con distance
+ *          fijo. Según su residuo, el bit de p se empareja con un bit del
+ *          mismo byte o del siguiente de una ventana de reversed_bits, cuyos
+ *          bits se reordenan dentro de cada byte. La cuenta es la cantidad
+ *          de bits encendidos del AND entre bits y esa ventana, que se
+ *          recorre por palabras con un kernel vectorizado para AVX-512 con
+ *          GFNI, AVX2 o sin vectorizar, elegido al cargar el programa según
+ *          el procesador.
+ * @code
+ *   uint64_t count = sieve_count_pairs(sieve, 10, 2, 5);
+ *   //Retorna: 2, correspondiente a [3, 7] y [5, 5]
+ * @endcode
+ * @param sieve estructura de datos
+ * @param number número par menor o igual a limit
+ * @param minimum menor valor admitido para p
+ * @param maximum mayor valor admitido para p, a lo sumo number / 2
+ * @return uint64_t cantidad de parejas encontradas
+ */
+uint64_t sieve_count_pairs(sieve_t* sieve, uint32_t number, uint32_t minimum,
+                           uint32_t maximum);
+
+/**
+ * @brief Retorna el campo limit de la estructura
+ * @code
+ *   uint32_t limit = sieve_get_limit(sieve);
+ * @endcode
+ * @param sieve estructura de datos
+ * @return uint32_t número hasta el cual se conocen los primos
+ */
+uint32_t sieve_get_limit(sieve_t* sieve);
+
+/**
+ * @brief Valida que un número sea primo con la prueba de Miller-Rabin
+ * @details Usa como testigos los doce primeros primos, con los cuales la
+ *          prueba es determinista para cualquier número de 64 bits
+ * @code
+ *   bool is_prime = sieve_miller_rabin(1000000007);
+ * @endcode
+ * @param number número a validar
+ * @return
+ *   true: si el número es primo
+ *   false: si el número no es primo
+ */
+bool sieve_miller_rabin(uint64_t number);
+
+/**
+ * @brief Retorna el menor número primo mayor que number
+ * @details Busca el siguiente bit encendido de la rueda y, si number
+ *          excede la criba, prueba los números impares siguientes con
+ *          sieve_miller_rabin
+ * @code
+ *   uint64_t prime = sieve_next_prime(sieve, 7);
+ *   //Retorna: 11
+ * @endcode
+ * @param sieve estructura de datos
+ * @param number número a partir del cual se busca
+ * @return uint64_t siguiente número primo
+ */
+uint64_t sieve_next_prime(sieve_t* sieve, uint64_t number);
+
+/**
+ * @brief Inicializa un recorrido de los primos entre minimum y maximum
+ * @code
+ *   sieve_iterator_t iterator;
+ *   sieve_iterator_init(&iterator, sieve, 10, 30);
+ * @endcode
+ * @param iterator recorrido a inicializar
+ * @param sieve estructura de datos
+ * @param minimum menor primo a recorrer
+ * @param maximum mayor primo a recorrer, a lo sumo limit
+ */
+void sieve_iterator_init(sieve_iterator_t* iterator, sieve_t* sieve,
+                         uint64_t minimum, uint64_t maximum);
+
+/**
+ * @brief Valida que un número sea primo consultando la rueda
+ * @details Se define en el encabezado para que los ciclos de cálculo de
+ *          sumas puedan expandirla en línea, pues se invoca una vez por
+ *          cada combinación evaluada. Los números mayores que limit se
+ *          validan individualmente con sieve_miller_rabin.
+ * @code
+ *   bool is_prime = sieve_is_prime(sieve, 7);
+ * @endcode
+ * @param sieve estructura de datos
+ * @param number número a validar
+ * @return
+ *   true: si el número es primo
+ *   false: si el número no es primo
+ */
+static inline bool sieve_is_prime(sieve_t* sieve, uint64_t number) {
+  if (number % 2 == 0)
+    return number == 2;
+  if (number > sieve -> limit)
+    return sieve_miller_rabin(number);
+  uint8_t mask = SIEVE_WHEEL_MASKS[number % 30];
+  // Los múltiplos de 3 y 5 no están en la rueda
+  if (!mask)
+    return number == 3 || number == 5;
+  return ((const uint8_t*) sieve -> bits)[number / 30] & mask;
+}
+
+/**
+ * @brief Retorna el siguiente primo del recorrido
+ * @details Se define en el encabezado para que los ciclos de cálculo de
+ *          sumas puedan expandirla en línea. Salta las palabras de la rueda
+ *          sin primos y extrae el menor bit encendido de la palabra actual.
+ * @code
+ *   for (uint64_t prime = sieve_iterator_next(&iterator); prime;
+ *        prime = sieve_iterator_next(&iterator)) {
+ *   }
+ * @endcode
+ * @param iterator recorrido inicializado con sieve_iterator_init
+ * @return uint64_t siguiente primo, o cero si ya no quedan
+ */
+static inline uint64_t sieve_iterator_next(sieve_iterator_t* iterator) {
+  // Los primos 2, 3 y 5 son las posiciones de sus bits
+  if (iterator -> small_primes) {
+    uint32_t prime = (uint32_t) __builtin_ctz(iterator -> small_primes);
+    iterator -> small_primes &= iterator -> small_primes - 1;
+    return prime;
+  }
+  while (!iterator -> bits) {
+    if (iterator -> word >= iterator -> last_word)
+      return 0;
+    iterator -> bits = iterator -> words[++iterator -> word];
+    if (iterator -> word == iterator -> last_word)
+      iterator -> bits &= iterator -> last_mask;
+  }
+  uint32_t bit = (uint32_t) __builtin_ctzll(iterator -> bits);
+  iterator -> bits &= iterator -> bits - 1;
+  return SIEVE_WORD_SPAN * iterator -> word + 30 * (bit / 8) +
+         SIEVE_WHEEL_RESIDUES[bit % 8];
+}
+
+#endif  // !SIEVE_H
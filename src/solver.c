@@ -5,82 +5,651 @@
 #include "solver.h"
 
 /**
- * @brief Lee los valores introducidos en la entrada estandar y opcionalmente
- *        la cantidad de hilos que el usario desea utilizar
- * @code 
- *  solver_read(solver, argc, argv);
+ * @brief Lee los argumentos del programa
+ * @details Un argumento numérico indica la cantidad de hilos que el usuario
+ *          desea utilizar y --stream solicita calcular la entrada por flujo
+ *          con pipeline_t, lo cual también se hace si la entrada estándar es
+ *          una terminal para responder cada valor en cuanto se digita. El
+ *          argumento --cache seguido de una ruta conserva el caché de
+ *          resultados en ese archivo entre corridas, --table seguido de una
+ *          ruta responde con una tabla precalculada y --precompute seguido
+ *          de un límite y una ruta solo escribe esa tabla. El argumento
+ *          --stats, o la variable de entorno GOLDBACH_STATS con la ruta de
+ *          un archivo, solicita escribir las mediciones de la corrida como
+ *          JSON en stderr o en ese archivo, y --profile agrega a ellas los
+ *          contadores de hardware de cada fase, núcleo e hilo. El argumento
+ *          --serve seguido de una ruta responde consultas por un socket en
+ *          esa ruta en lugar de leer la entrada estándar.
+ * @code
+ *  solver_read_arguments(solver, argc, argv);
  * @endcode
  * @param solver estructura
  * @param argc
  * @param argv
  */
-void solver_read(solver_t* solver, int argc, char* argv[]);
+void solver_read_arguments(solver_t* solver, int argc, char* argv[]);
+
+/**
+ * @brief Responde la entrada estándar por lotes o por flujo
+ * @details Carga la tabla precalculada y el caché de corridas anteriores si
+ *          se indicaron, crea el engine que comparten todos los modos y,
+ *          con --pool, --pin o --serve, el pool que reparte sus lotes y
+ *          consultas, y guarda el caché al terminar
+ * @code
+ *  solver_answer(solver);
+ * @endcode
+ * @param solver estructura con los argumentos ya leídos
+ */
+void solver_answer(solver_t* solver);
+
+/**
+ * @brief Lee los valores introducidos en la entrada estandar
+ * @code 
+ *  solver_read(solver);
+ * @endcode
+ * @param solver estructura
+ */
+void solver_read(solver_t* solver);
+
+/**
+ * @brief Calcula e imprime el lote completo guardado en el arreglo
+ * @details El cálculo se hace con engine_compute, que construye la criba
+ *          del tamaño exacto del mayor valor y la tabla si conviene, y
+ *          calcula de la entrada más cara a la más barata
+ * @code
+ *  solver_run_batch(solver);
+ * @endcode
+ * @param solver estructura
+ */
+void solver_run_batch(solver_t* solver);
+
+/**
+ * @brief Calcula e imprime la entrada estándar por flujo con pipeline_t
+ * @details La memoria es proporcional a la ventana de la cola y no al tamaño
+ *          de la entrada, pero no se construye la tabla de cantidades pues
+ *          requiere conocer todo el lote
+ * @code
+ *  solver_run_stream(solver);
+ * @endcode
+ * @param solver estructura
+ */
+void solver_run_stream(solver_t* solver);
+
+/**
+ * @brief Responde consultas por un socket de dominio Unix con server_t
+ * @details Las cribas, la tabla y el caché de resultados permanecen en
+ *          memoria entre consultas hasta que el proceso recibe SIGINT o
+ *          SIGTERM. Los valores se calculan en los hilos del pool del
+ *          solver, fijados a un procesador con --pin.
+ * @code
+ *  solver_serve(solver);
+ * @endcode
+ * @param solver estructura
+ */
+void solver_serve(solver_t* solver);
 
 /**
  * @brief Imprime las soluciones para cada valor del archivo
  * @code 
- *  solver_print(solver);
+ *  solver_print(solver, sieve);
  * @endcode
  * @param solver estructura
+ * @param sieve criba con la que se calculó el lote, de la que se enumeran
+ *        las sumas listadas
+ */
+void solver_print(solver_t* solver, sieve_t* sieve);
+
+/**
+ * @brief Escribe la tabla de cantidades de sumas fuertes y débiles de todos
+ *        los números hasta el límite solicitado, sin leer la entrada
+ * @code
+ *  solver_precompute(solver);
+ * @endcode
+ * @param solver estructura
+ */
+void solver_precompute(solver_t* solver);
+
+/**
+ * @brief Indica si la tabla cargada del solver responde la entrada sin
+ *        requerir la criba
+ * @code
+ *  bool is_answered = solver_has_count(solver, goldbach);
+ * @endcode
+ * @param solver estructura
+ * @param goldbach entrada a consultar
+ * @return
+ *   true: si la entrada es positiva y su valor está dentro de la tabla
+ *   false: si la entrada debe calcularse o listar sus sumas
+ */
+bool solver_has_count(solver_t* solver, goldbach_t* goldbach);
+
+/**
+ * @brief Crea las mediciones de la corrida si se solicitaron
+ * @details Una ruta "-" o vacía escribe en stderr
+ * @code
+ *  solver_create_stats(solver);
+ * @endcode
+ * @param solver estructura con los argumentos ya leídos
+ */
+void solver_create_stats(solver_t* solver);
+
+#ifdef GOLDBACH_MPI
+/**
+ * @brief Comunica a todos los procesos el modo que eligió el proceso cero
+ * @details Solo el proceso cero lee la entrada estándar, mide, usa la tabla
+ *          y el caché, y atiende los modos por flujo, de servidor y de
+ *          precálculo. Los demás procesos únicamente calculan su parte de
+ *          los lotes.
+ * @code
+ *  solver_share_arguments(solver);
+ * @endcode
+ * @param solver estructura con los argumentos ya leídos
+ */
+void solver_share_arguments(solver_t* solver);
+
+/**
+ * @brief Calcula el lote repartido entre los procesos de MPI
+ * @details El proceso cero lee el lote y envía a cada proceso una parte de
+ *          los valores distintos con solver_partition. Cada proceso los
+ *          calcula con su propia criba y sus hilos mediante
+ *          solver_count_values, y el proceso cero recoge las cantidades,
+ *          las asigna a las entradas e imprime en el orden de entrada. Las
+ *          entradas que listan sus sumas las enumera el proceso cero al
+ *          imprimir, con su criba.
+ * @code
+ *  solver_run_distributed(solver);
+ * @endcode
+ * @param solver estructura
+ */
+void solver_run_distributed(solver_t* solver);
+
+/**
+ * @brief Reparte los valores distintos del lote entre los procesos según su
+ *        costo estimado
+ * @details Asigna los valores del más caro al más barato, cada uno al
+ *          proceso con menor costo acumulado. Los inválidos, los menores
+ *          que seis y los que responde la tabla no se reparten.
+ * @code
+ *  uint64_t* values = solver_partition(solver, sieve, positions,
+ *                                     send_counts);
+ * @endcode
+ * @param solver estructura con el lote leído
+ * @param sieve criba que abarca todo el lote, para estimar los costos
+ * @param positions posición en el arreglo retornado del valor de cada
+ *        entrada, o UINT32_MAX si la entrada no se reparte
+ * @param send_counts cantidad de valores de cada proceso
+ * @return uint64_t* valores de todos los procesos, agrupados por proceso en
+ *         orden, se debe liberar con free
+ */
+uint64_t* solver_partition(solver_t* solver, sieve_t* sieve,
+                           uint32_t* positions, int* send_counts);
+
+/**
+ * @brief Calcula la cantidad de sumas de cada valor con un lote propio
+ * @details El lote se calcula con engine_compute, es decir, con la criba,
+ *          la tabla si conviene, el orden y los hilos del engine del solver
+ * @code
+ *  solver_count_values(solver, values, value_count, counts);
+ * @endcode
+ * @param solver estructura de la que se toman el engine y las mediciones
+ * @param values valores positivos a calcular
+ * @param value_count cantidad de valores
+ * @param counts cantidad de sumas de cada valor
  */
-void solver_print(solver_t* solver);
+void solver_count_values(solver_t* solver, const uint64_t* values,
+                         uint32_t value_count, uint64_t* counts);
+#endif
 
 typedef struct solver {
   uint32_t thread_count;
+  bool is_streaming;
+  char* cache_path;
+  char* table_path;
+  char* precompute_path;
+  char* serve_path;
+  const char* stats_path;
+  bool is_profiling;
+  bool is_pooled;
+  bool is_pinned;
+  uint32_t precompute_limit;
+  int rank;
+  int rank_count;
   array_goldbach_t buffer;
+  arena_t arena;
+  count_table_t* table;
+  result_cache_t* cache;
+  pool_t* pool;
+  engine_t* engine;
+  stats_t* stats;
 } solver_t;
 
 solver_t* solver_create() {
   // Crear e inicializar campos de la estructura
   solver_t* solver = (solver_t*) calloc(1, sizeof(solver_t));
   solver -> thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+  solver -> rank_count = 1;
+#ifdef GOLDBACH_MPI
+  MPI_Comm_rank(MPI_COMM_WORLD, &solver -> rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &solver -> rank_count);
+#endif
   array_goldbach_init(&solver -> buffer);
+  arena_init(&solver -> arena);
+  solver -> cache = result_cache_create();
   return solver;
 }
 
-void solver_read(solver_t* solver, int argc, char* argv[]) {
+void solver_read_arguments(solver_t* solver, int argc, char* argv[]) {
   assert(solver);
-  char data[100];
-  if (argc == 2) {
-    // Leer cantidad de hilos que el usuario quiere emplear
-    if (sscanf(argv[1], "%" SCNu32, &solver -> thread_count) == 1) {
-    } else {
+  // Calcular por flujo si los valores se digitan en una terminal
+  solver -> is_streaming = isatty(STDIN_FILENO);
+  solver -> stats_path = getenv("GOLDBACH_STATS");
+  for (int index = 1; index < argc; ++index) {
+    if (strcmp(argv[index], "--stream") == 0) {
+      solver -> is_streaming = true;
+    } else if (strcmp(argv[index], "--stats") == 0) {
+      // Escribir las mediciones en stderr
+      solver -> stats_path = "-";
+    } else if (strcmp(argv[index], "--pool") == 0) {
+      // Repartir el lote con robo de trabajo en lugar de OpenMP
+      solver -> is_pooled = true;
+    } else if (strcmp(argv[index], "--pin") == 0) {
+      // Repartir con robo de trabajo y fijar cada hilo a un procesador
+      solver -> is_pooled = true;
+      solver -> is_pinned = true;
+    } else if (strcmp(argv[index], "--profile") == 0) {
+      // Medir con contadores de hardware, en stderr salvo otra ruta
+      solver -> is_profiling = true;
+    } else if (strcmp(argv[index], "--cache") == 0 && index + 1 < argc) {
+      // Leer la ruta del archivo donde se conserva el caché
+      solver -> cache_path = argv[++index];
+    } else if (strcmp(argv[index], "--table") == 0 && index + 1 < argc) {
+      // Leer la ruta de la tabla precalculada
+      solver -> table_path = argv[++index];
+    } else if (strcmp(argv[index], "--serve") == 0 && index + 1 < argc) {
+      // Leer la ruta del socket donde se atienden consultas
+      solver -> serve_path = argv[++index];
+    } else if (strcmp(argv[index], "--precompute") == 0 && index + 2 < argc) {
+      // Leer el límite y la ruta de la tabla a precalcular
+      if (sscanf(argv[++index], "%" SCNu32, &solver -> precompute_limit) != 1)
+        fprintf(stderr, "Error: invalid precompute limit\n");
+      solver -> precompute_path = argv[++index];
+    } else if (sscanf(argv[index], "%" SCNu32, &solver -> thread_count) != 1) {
+      // Leer cantidad de hilos que el usuario quiere emplear
       fprintf(stderr, "Error: invalid thread count\n");
     }
   }
-  // Craer goldbach y agregarlo al arreglo para cada valor introducido
-  while (fscanf(stdin, "%s", (char*) data) == 1) {
-    goldbach_t* goldbach = goldbach_create((char*)data);
+}
+
+void solver_read(solver_t* solver) {
+  assert(solver);
+  reader_t reader;
+  const char* token = NULL;
+  uint32_t length = 0;
+  stats_mark_t start;
+  stats_mark(solver -> stats, &start);
+  reader_init(&reader, stdin);
+  /* Craer goldbach en el arena del lote y agregarlo al arreglo para cada
+     valor introducido */
+  while (reader_next(&reader, &token, &length)) {
+    goldbach_t* goldbach = goldbach_create(token, length, &solver -> arena);
     array_goldbach_add(&solver -> buffer, goldbach);
+    if (solver -> stats)
+      stats_count_entry(solver -> stats, goldbach_get_value(goldbach));
   }
+  reader_destroy(&reader);
+  if (solver -> stats)
+    stats_add_phase(solver -> stats, STATS_READ, &start);
 }
 
 void solver_run(solver_t* solver, int argc, char* argv[]) {
   assert(solver);
-  solver_read(solver, argc, argv);
-  goldbach_t** buffer_elements = array_goldbach_get_elements(&solver -> buffer);
-  uint32_t buffer_size = array_goldbach_get_count(&solver -> buffer);
-  // Cálculo de sumas de Goldbach
-  #pragma omp parallel for schedule(dynamic) \
-    num_threads(solver -> thread_count) default(none) \
-    shared(buffer_elements, buffer_size)
-    for (uint32_t index = 0; index < buffer_size; ++index)
-      goldbach_run(buffer_elements[index]);
-  solver_print(solver);  // Imprimir sumas de Goldbach
+  solver_read_arguments(solver, argc, argv);
+#ifdef GOLDBACH_MPI
+  solver_share_arguments(solver);
+  if (solver -> rank > 0 && (solver -> precompute_path ||
+      solver -> serve_path || solver -> is_streaming))
+    return;
+#endif
+  if (solver -> is_profiling && !solver -> stats_path)
+    solver -> stats_path = "-";
+  if (solver -> stats_path)
+    solver_create_stats(solver);
+  if (solver -> precompute_path) {
+    solver_precompute(solver);
+  } else {
+    solver_answer(solver);
+  }
+  if (solver -> stats)
+    stats_write(solver -> stats);
+}
+
+void solver_answer(solver_t* solver) {
+  assert(solver);
+  // Responder con la tabla precalculada los valores dentro de ella
+  if (solver -> table_path) {
+    solver -> table = count_table_load(solver -> table_path);
+    if (!solver -> table)
+      fprintf(stderr, "Error: could not load count table\n");
+  }
+  // Reutilizar los resultados de corridas anteriores si se solicitó
+  if (solver -> cache_path &&
+      !result_cache_load(solver -> cache, solver -> cache_path))
+    fprintf(stderr, "Error: invalid cache file, it will be replaced\n");
+  /* Repartir los lotes con robo de trabajo si se solicitó y siempre las
+     consultas del servidor */
+  if (solver -> is_pooled || solver -> serve_path)
+    solver -> pool = pool_create(solver -> thread_count, solver -> is_pinned);
+  solver -> engine = engine_create_shared(solver -> thread_count,
+                                          solver -> cache, solver -> table,
+                                          solver -> pool);
+  if (solver -> serve_path)
+    solver_serve(solver);
+  else if (solver -> is_streaming)
+    solver_run_stream(solver);
+  else
+    solver_run_batch(solver);
+  if (solver -> cache_path &&
+      !result_cache_save(solver -> cache, solver -> cache_path))
+    fprintf(stderr, "Error: could not write cache file\n");
 }
 
-void solver_print(solver_t* solver) {
+void solver_run_stream(solver_t* solver) {
+  assert(solver);
+  // Leer, calcular e imprimir a la vez con una ventana acotada de entradas
+  if (solver -> stats)
+    solver -> stats -> mode = "stream";
+  pipeline_t* pipeline = pipeline_create(solver -> engine, solver -> stats);
+  pipeline_run(pipeline, stdin);
+  pipeline_destroy(pipeline);
+}
+
+void solver_serve(solver_t* solver) {
+  assert(solver);
+  // Conservar cribas, tabla y caché entre consultas hasta recibir una señal
+  server_t* server = server_create(solver -> serve_path, solver -> engine);
+  if (!server_run(server))
+    fprintf(stderr, "Error: could not listen on socket\n");
+  server_destroy(server);
+}
+
+void solver_run_batch(solver_t* solver) {
+  assert(solver);
+#ifdef GOLDBACH_MPI
+  if (solver -> rank_count > 1) {
+    solver_run_distributed(solver);
+    return;
+  }
+#endif
+  stats_t* stats = solver -> stats;
+  solver_read(solver);
+  goldbach_t** elements = array_goldbach_get_elements(&solver -> buffer);
+  uint32_t element_count = array_goldbach_get_count(&solver -> buffer);
+  // Calcular el lote con la criba, la tabla y el orden del engine
+  engine_compute(solver -> engine, elements, element_count, stats);
+  stats_mark_t start;
+  stats_mark(stats, &start);
+  // Imprimir sumas de Goldbach en el orden de entrada, con la criba del lote
+  solver_print(solver, engine_get_batch_sieve(solver -> engine, elements,
+                                              element_count));
+  if (stats)
+    stats_add_phase(stats, STATS_PRINT, &start);
+}
+
+bool solver_has_count(solver_t* solver, goldbach_t* goldbach) {
+  assert(solver);
+  uint64_t value = goldbach_get_value(goldbach);
+  // Las entradas que listan sus sumas requieren la criba para enumerarlas
+  return solver -> table && !goldbach_is_listed(goldbach) &&
+         count_table_has_count(solver -> table, value, value % 2 == 0);
+}
+
+void solver_precompute(solver_t* solver) {
+  assert(solver);
+  uint32_t limit = solver -> precompute_limit;
+  if (limit > COUNT_TABLE_MAX_FILE_LIMIT) {
+    fprintf(stderr, "Error: precompute limit must not exceed %u\n",
+            COUNT_TABLE_MAX_FILE_LIMIT);
+    return;
+  }
+  // Calcular las cantidades de todos los números hasta limit y guardarlas
+  if (solver -> stats)
+    solver -> stats -> mode = "precompute";
+  stats_mark_t start;
+  stats_mark(solver -> stats, &start);
+  sieve_t* sieve = sieve_create(limit);
+  if (solver -> stats)
+    stats_add_phase(solver -> stats, STATS_SIEVE, &start);
+  stats_mark(solver -> stats, &start);
+  solver -> table = count_table_precompute(sieve, limit,
+                                           solver -> thread_count);
+  sieve_destroy(sieve);
+  if (solver -> stats)
+    stats_add_phase(solver -> stats, STATS_TABLE, &start);
+  if (!count_table_save(solver -> table, solver -> precompute_path))
+    fprintf(stderr, "Error: could not write count table\n");
+}
+
+void solver_create_stats(solver_t* solver) {
+  assert(solver);
+  const char* path = solver -> stats_path;
+  FILE* output = path[0] == '\0' || strcmp(path, "-") == 0
+                 ? stderr : fopen(path, "w");
+  if (output)
+    solver -> stats = stats_create(output, solver -> thread_count,
+                                   solver -> is_profiling);
+  else
+    fprintf(stderr, "Error: could not write stats file\n");
+}
+
+void solver_print(solver_t* solver, sieve_t* sieve) {
   assert(solver);
   uint32_t element_count = array_goldbach_get_count(&solver -> buffer);
   goldbach_t** elements = array_goldbach_get_elements(&solver -> buffer);
+  writer_t writer;
+  writer_init(&writer, stdout);
   // Imprimir las Sumas de Goldbach para cada valor del arreglo
   for (uint32_t index = 0; index < element_count; ++index)
-    goldbach_print(elements[index]);
+    goldbach_print(elements[index], sieve, &writer);
+  writer_destroy(&writer);
+}
+
+#ifdef GOLDBACH_MPI
+void solver_share_arguments(solver_t* solver) {
+  assert(solver);
+  // Todos los procesos deben tomar el mismo camino para comunicarse
+  int is_streaming = solver -> is_streaming;
+  MPI_Bcast(&is_streaming, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  solver -> is_streaming = is_streaming;
+  if (solver -> rank > 0) {
+    solver -> stats_path = NULL;
+    solver -> is_profiling = false;
+    solver -> cache_path = NULL;
+    solver -> table_path = NULL;
+  }
+}
+
+void solver_run_distributed(solver_t* solver) {
+  assert(solver);
+  stats_t* stats = solver -> stats;
+  bool is_root = solver -> rank == 0;
+  int* send_counts = NULL;
+  int* displacements = NULL;
+  uint32_t* positions = NULL;
+  uint64_t* values = NULL;
+  uint64_t* counts = NULL;
+  sieve_t* sieve = NULL;
+  if (is_root) {
+    if (stats)
+      stats -> mode = "distributed";
+    // Leer el lote y repartir sus valores distintos según su costo
+    solver_read(solver);
+    uint32_t element_count = array_goldbach_get_count(&solver -> buffer);
+    goldbach_t** elements = array_goldbach_get_elements(&solver -> buffer);
+    stats_mark_t start;
+    stats_mark(stats, &start);
+    sieve = engine_get_batch_sieve(solver -> engine, elements,
+                                   element_count);
+    if (stats)
+      stats_add_phase(stats, STATS_SIEVE, &start);
+    positions = (uint32_t*) malloc((element_count + 1) * sizeof(uint32_t));
+    send_counts = (int*) calloc(solver -> rank_count, sizeof(int));
+    displacements = (int*) calloc(solver -> rank_count, sizeof(int));
+    stats_mark(stats, &start);
+    values = solver_partition(solver, sieve, positions, send_counts);
+    if (stats)
+      stats_add_phase(stats, STATS_SCHEDULE, &start);
+    for (int rank = 1; rank < solver -> rank_count; ++rank)
+      displacements[rank] = displacements[rank - 1] + send_counts[rank - 1];
+    counts = (uint64_t*) malloc((displacements[solver -> rank_count - 1] +
+                                 send_counts[solver -> rank_count - 1] + 1)
+                                * sizeof(uint64_t));
+  }
+  // Enviar a cada proceso sus valores
+  int local_count = 0;
+  MPI_Scatter(send_counts, 1, MPI_INT, &local_count, 1, MPI_INT, 0,
+              MPI_COMM_WORLD);
+  uint64_t* local_values = (uint64_t*) malloc((local_count + 1)
+                                              * sizeof(uint64_t));
+  uint64_t* local_counts = (uint64_t*) malloc((local_count + 1)
+                                              * sizeof(uint64_t));
+  MPI_Scatterv(values, send_counts, displacements, MPI_UINT64_T,
+               local_values, local_count, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+  solver_count_values(solver, local_values, local_count, local_counts);
+  // Recoger las cantidades en el mismo orden en que se enviaron los valores
+  MPI_Gatherv(local_counts, local_count, MPI_UINT64_T, counts, send_counts,
+              displacements, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+  if (is_root) {
+    uint32_t element_count = array_goldbach_get_count(&solver -> buffer);
+    goldbach_t** elements = array_goldbach_get_elements(&solver -> buffer);
+    // Las entradas que no se repartieron se responden aquí sin cálculo
+    for (uint32_t index = 0; index < element_count; ++index) {
+      if (positions[index] != UINT32_MAX)
+        goldbach_share_result(elements[index], counts[positions[index]]);
+      else
+        goldbach_run(elements[index], sieve, solver -> table);
+    }
+    stats_mark_t start;
+    stats_mark(stats, &start);
+    solver_print(solver, sieve);  // Imprimir en el orden de entrada
+    if (stats)
+      stats_add_phase(stats, STATS_PRINT, &start);
+  }
+  free(local_counts);
+  free(local_values);
+  free(counts);
+  free(values);
+  free(displacements);
+  free(send_counts);
+  free(positions);
+}
+
+uint64_t* solver_partition(solver_t* solver, sieve_t* sieve,
+                           uint32_t* positions, int* send_counts) {
+  assert(solver);
+  uint32_t element_count = array_goldbach_get_count(&solver -> buffer);
+  goldbach_t** elements = array_goldbach_get_elements(&solver -> buffer);
+  engine_task_t* tasks = (engine_task_t*) malloc((element_count + 1)
+                                                 * sizeof(engine_task_t));
+  uint32_t task_count = 0;
+  for (uint32_t index = 0; index < element_count; ++index) {
+    positions[index] = UINT32_MAX;
+    uint64_t value = goldbach_get_value(elements[index]);
+    if (value > 5 && !solver_has_count(solver, elements[index])) {
+      tasks[task_count].cost = 0;
+      tasks[task_count].value = value;
+      tasks[task_count++].index = index;
+    }
+  }
+  /* Agrupar las repeticiones ordenando por valor, cada entrada guarda
+     temporalmente en positions el número de su valor distinto */
+  qsort(tasks, task_count, sizeof(engine_task_t), engine_compare_tasks);
+  uint32_t value_count = 0;
+  for (uint32_t index = 0; index < task_count; ++index) {
+    engine_task_t task = tasks[index];
+    if (value_count == 0 || tasks[value_count - 1].value != task.value)
+      tasks[value_count++] = task;
+    positions[task.index] = value_count - 1;
+  }
+  // Estimar el costo de cada valor distinto con una de sus entradas
+  for (uint32_t index = 0; index < value_count; ++index) {
+    tasks[index].cost = goldbach_estimate_cost(elements[tasks[index].index],
+                                               sieve, NULL);
+    tasks[index].index = index;
+  }
+  qsort(tasks, value_count, sizeof(engine_task_t), engine_compare_tasks);
+  // Asignar cada valor, del más caro al más barato, al proceso menos cargado
+  int rank_count = solver -> rank_count;
+  double* loads = (double*) calloc(rank_count, sizeof(double));
+  int* owners = (int*) malloc((value_count + 1) * sizeof(int));
+  for (uint32_t index = 0; index < value_count; ++index) {
+    int owner = 0;
+    for (int rank = 1; rank < rank_count; ++rank) {
+      if (loads[rank] < loads[owner])
+        owner = rank;
+    }
+    loads[owner] += (double) tasks[index].cost;
+    owners[index] = owner;
+    ++send_counts[owner];
+  }
+  // Agrupar los valores por proceso y anotar la posición de cada uno
+  uint32_t* next = (uint32_t*) calloc(rank_count, sizeof(uint32_t));
+  for (int rank = 1; rank < rank_count; ++rank)
+    next[rank] = next[rank - 1] + send_counts[rank - 1];
+  uint64_t* values = (uint64_t*) malloc((value_count + 1) * sizeof(uint64_t));
+  uint32_t* value_positions = (uint32_t*) malloc((value_count + 1)
+                                                 * sizeof(uint32_t));
+  for (uint32_t index = 0; index < value_count; ++index) {
+    uint32_t position = next[owners[index]]++;
+    values[position] = tasks[index].value;
+    value_positions[tasks[index].index] = position;
+  }
+  for (uint32_t index = 0; index < element_count; ++index) {
+    if (positions[index] != UINT32_MAX)
+      positions[index] = value_positions[positions[index]];
+  }
+  free(value_positions);
+  free(next);
+  free(owners);
+  free(loads);
+  free(tasks);
+  return values;
 }
 
+void solver_count_values(solver_t* solver, const uint64_t* values,
+                         uint32_t value_count, uint64_t* counts) {
+  assert(solver);
+  arena_t arena;
+  arena_init(&arena);
+  goldbach_t** entries = (goldbach_t**) malloc((value_count + 1)
+                                               * sizeof(goldbach_t*));
+  /* Calcular los valores, que ya no tienen repeticiones, como un lote del
+     engine, cuya criba en el proceso cero ya abarca todo el lote */
+  for (uint32_t index = 0; index < value_count; ++index)
+    entries[index] = goldbach_create_value(values[index], false, &arena);
+  engine_compute(solver -> engine, entries, value_count, solver -> stats);
+  for (uint32_t index = 0; index < value_count; ++index)
+    counts[index] = goldbach_get_count(entries[index]);
+  free(entries);
+  // Las entradas se liberan de una vez junto con el arena
+  arena_destroy(&arena);
+}
+
+#endif
+
 void solver_destroy(solver_t* solver) {
   assert(solver);
   // Liberar memoria empleada por la estructura
   array_goldbach_destroy(&solver -> buffer);
+  // Las entradas del lote se liberan de una vez junto con el arena
+  arena_destroy(&solver -> arena);
+  result_cache_destroy(solver -> cache);
+  if (solver -> table)
+    count_table_destroy(solver -> table);
+  if (solver -> engine)
+    engine_destroy(solver -> engine);
+  if (solver -> pool)
+    pool_destroy(solver -> pool);
+  if (solver -> stats)
+    stats_destroy(solver -> stats);
   free(solver);
 }
@@ -5,11 +5,25 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <unistd.h>
 #include <pthread.h>
+#include "arena.h"
+#include "sieve.h"
+#include "count_table.h"
+#include "engine_internal.h"
 #include "goldbach.h"
 #include "array_goldbach.h"
+#include "pipeline.h"
+#include "pool.h"
+#include "reader.h"
+#include "result_cache.h"
+#include "server.h"
+#include "stats.h"
+#ifdef GOLDBACH_MPI
+#include <mpi.h>
+#endif
 
 /**
  * @brief Estructura de datos, contiene campo array (array_goldbach_t*)
@@ -0,0 +1,315 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "stats.h"
+
+/// Nombres de las fases en el JSON, en el orden de stats_phase_t
+static const char* const STATS_PHASE_NAMES[STATS_PHASE_COUNT] = {
+  "read", "sieve", "table", "schedule", "sums", "print"
+};
+
+/// Nombres de los contadores en el JSON, en el orden de stats_counter_t
+static const char* const STATS_COUNTER_NAMES[STATS_COUNTER_COUNT] = {
+  "task_clock_ns", "cycles", "instructions", "cache_misses", "branch_misses"
+};
+
+/// Tipo de evento de perf_event_open de cada contador
+static const uint32_t STATS_COUNTER_TYPES[STATS_COUNTER_COUNT] = {
+  PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+  PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+};
+
+/// Evento de perf_event_open de cada contador
+static const uint64_t STATS_COUNTER_CONFIGS[STATS_COUNTER_COUNT] = {
+  PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/// Grupo de contadores de un hilo
+typedef struct stats_events {
+  bool is_open;
+  int group;
+  int8_t positions[STATS_COUNTER_COUNT];
+} stats_events_t;
+
+/// Grupo de contadores del hilo actual, se abre en su primera medición
+static __thread stats_events_t stats_events;
+/// Estructura que mide la entrada en curso del hilo actual, o NULL
+static __thread stats_t* stats_current;
+
+/**
+ * @brief Abre el grupo de contadores del hilo actual
+ * @details El primer contador que se logra abrir es el líder del grupo, de
+ *          forma que una sola lectura retorna todos. Los que fallan, por
+ *          ejemplo los de hardware en una máquina virtual, quedan sin
+ *          posición y se reportan como null si ningún hilo los abrió.
+ * @code
+ *   stats_open_events(stats, &stats_events);
+ * @endcode
+ * @param stats estructura de datos, registra los descriptores a cerrar
+ * @param events grupo del hilo actual
+ */
+void stats_open_events(stats_t* stats, stats_events_t* events);
+
+/**
+ * @brief Escribe un objeto JSON con los contadores disponibles
+ * @code
+ *   write_counters(stats, stats -> phase_counters[STATS_READ]);
+ * @endcode
+ * @param stats estructura de datos
+ * @param counters valor de cada contador
+ */
+void write_counters(stats_t* stats, const uint64_t* counters);
+
+stats_t* stats_create(FILE* output, uint32_t thread_count, bool is_profiling) {
+  assert(output);
+  // Crear e inicializar campos de la estructura
+  stats_t* stats = (stats_t*) calloc(1, sizeof(stats_t));
+  stats -> output = output;
+  stats -> mode = "batch";
+  stats -> is_profiling = is_profiling;
+  stats -> thread_count = thread_count ? thread_count : 1;
+  // Alinear las mediciones para que cada hilo empiece en su propia línea
+  stats -> threads = (stats_thread_t*) aligned_alloc(STATS_CACHE_LINE_SIZE,
+      stats -> thread_count * sizeof(stats_thread_t));
+  memset(stats -> threads, 0, stats -> thread_count * sizeof(stats_thread_t));
+  pthread_mutex_init(&stats -> mutex, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &stats -> start_time);
+  return stats;
+}
+
+void stats_mark(stats_t* stats, stats_mark_t* mark) {
+  assert(mark);
+  bool is_profiling = stats && stats -> is_profiling;
+  // Abrir el grupo del hilo antes de tomar el tiempo, para no medirlo
+  stats_events_t* events = &stats_events;
+  if (is_profiling && !events -> is_open)
+    stats_open_events(stats, events);
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  mark -> time = time.tv_sec + time.tv_nsec / 1000000000.0;
+  if (!is_profiling)
+    return;
+  // Leer de una vez todos los contadores del grupo del hilo
+  uint64_t values[1 + STATS_COUNTER_COUNT] = {0};
+  if (events -> group >= 0 &&
+      read(events -> group, values, sizeof(values)) < 0)
+    values[0] = 0;
+  for (uint32_t counter = 0; counter < STATS_COUNTER_COUNT; ++counter) {
+    int8_t position = events -> positions[counter];
+    mark -> counters[counter] = position >= 0 && (uint64_t) position
+                                < values[0] ? values[1 + position] : 0;
+  }
+}
+
+void stats_open_events(stats_t* stats, stats_events_t* events) {
+  assert(stats);
+  assert(events);
+  events -> is_open = true;
+  events -> group = -1;
+  int8_t position = 0;
+  pthread_mutex_lock(&stats -> mutex);
+  for (uint32_t counter = 0; counter < STATS_COUNTER_COUNT; ++counter) {
+    // Contar solo el espacio de usuario del hilo actual en cualquier CPU
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = STATS_COUNTER_TYPES[counter];
+    attributes.config = STATS_COUNTER_CONFIGS[counter];
+    attributes.read_format = PERF_FORMAT_GROUP;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    int descriptor = (int) syscall(SYS_perf_event_open, &attributes, 0, -1,
+                                   events -> group, 0);
+    if (descriptor < 0) {
+      events -> positions[counter] = -1;
+      continue;
+    }
+    if (events -> group < 0)
+      events -> group = descriptor;
+    events -> positions[counter] = position++;
+    stats -> has_counter[counter] = true;
+    // Registrar el descriptor para cerrarlo al destruir la estructura
+    int* descriptors = (int*) realloc(stats -> descriptors,
+        (stats -> descriptor_count + 1) * sizeof(int));
+    if (descriptors) {
+      stats -> descriptors = descriptors;
+      stats -> descriptors[stats -> descriptor_count++] = descriptor;
+    }
+  }
+  pthread_mutex_unlock(&stats -> mutex);
+}
+
+void stats_add_phase(stats_t* stats, stats_phase_t phase,
+                     const stats_mark_t* start) {
+  assert(stats);
+  assert(phase < STATS_PHASE_COUNT);
+  stats_mark_t finish;
+  stats_mark(stats, &finish);
+  stats -> phase_times[phase] += finish.time - start -> time;
+  // Los contadores de sums se toman de los hilos de cálculo
+  if (phase != STATS_SUMS) {
+    for (uint32_t counter = 0; counter < STATS_COUNTER_COUNT; ++counter) {
+      stats -> phase_counters[phase][counter] += finish.counters[counter]
+                                                 - start -> counters[counter];
+    }
+  }
+}
+
+void stats_start_busy(stats_t* stats, stats_mark_t* start) {
+  assert(stats);
+  stats_mark(stats, start);
+  stats_current = stats;
+}
+
+stats_t* stats_get_current(void) {
+  return stats_current;
+}
+
+void stats_add_busy(stats_t* stats, uint32_t thread,
+                    const stats_mark_t* start, uint64_t value) {
+  assert(stats);
+  stats_current = NULL;
+  stats_add_task(stats, thread, start, value);
+  if (thread < stats -> thread_count)
+    ++stats -> threads[thread].entry_count;
+}
+
+void stats_add_task(stats_t* stats, uint32_t thread,
+                    const stats_mark_t* start, uint64_t value) {
+  assert(stats);
+  // Cada hilo actualiza solo sus propias líneas de caché
+  if (thread < stats -> thread_count) {
+    stats_mark_t finish;
+    stats_mark(stats, &finish);
+    stats_thread_t* current = &stats -> threads[thread];
+    current -> busy_time += finish.time - start -> time;
+    stats_kernel_t kernel = value <= 5 ? STATS_OTHER_ENTRIES
+                            : value % 2 == 0 ? STATS_STRONG_SUMS
+                            : STATS_WEAK_SUMS;
+    for (uint32_t counter = 0; counter < STATS_COUNTER_COUNT; ++counter) {
+      current -> counters[kernel][counter] += finish.counters[counter]
+                                              - start -> counters[counter];
+    }
+  }
+}
+
+void stats_count_entry(stats_t* stats, uint64_t value) {
+  assert(stats);
+  if (value <= 5)
+    ++stats -> invalid_count;
+  else if (value % 2 == 0)
+    ++stats -> strong_count;
+  else
+    ++stats -> weak_count;
+}
+
+void stats_write(stats_t* stats) {
+  assert(stats);
+  FILE* output = stats -> output;
+  double start_time = stats -> start_time.tv_sec
+                      + stats -> start_time.tv_nsec / 1000000000.0;
+  stats_mark_t finish;
+  stats_mark(NULL, &finish);
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // Datos generales de la corrida, ru_maxrss está en kilobytes en Linux
+  fprintf(output, "{\"mode\": \"%s\", \"threads\": %" PRIu32
+          ", \"wall_seconds\": %.9f, \"peak_memory_kb\": %ld,\n",
+          stats -> mode, stats -> thread_count, finish.time - start_time,
+          usage.ru_maxrss);
+  fprintf(output, " \"phases\": {");
+  for (uint32_t phase = 0; phase < STATS_PHASE_COUNT; ++phase) {
+    fprintf(output, "%s\"%s\": %.9f", phase ? ", " : "",
+            STATS_PHASE_NAMES[phase], stats -> phase_times[phase]);
+  }
+  fprintf(output, "},\n \"entries\": {\"total\": %" PRIu64 ", \"strong\": %"
+          PRIu64 ", \"weak\": %" PRIu64 ", \"invalid\": %" PRIu64 "},\n",
+          stats -> strong_count + stats -> weak_count
+          + stats -> invalid_count, stats -> strong_count,
+          stats -> weak_count, stats -> invalid_count);
+  /* Sumar los contadores de los hilos por núcleo y en total, que son los de
+     la fase sums */
+  uint64_t kernel_counters[STATS_KERNEL_COUNT][STATS_COUNTER_COUNT] = {{0}};
+  uint64_t sum_counters[STATS_COUNTER_COUNT] = {0};
+  uint64_t thread_counters[STATS_COUNTER_COUNT];
+  for (uint32_t thread = 0; thread < stats -> thread_count; ++thread) {
+    for (uint32_t kernel = 0; kernel < STATS_KERNEL_COUNT; ++kernel) {
+      for (uint32_t counter = 0; counter < STATS_COUNTER_COUNT; ++counter) {
+        uint64_t value = stats -> threads[thread].counters[kernel][counter];
+        kernel_counters[kernel][counter] += value;
+        sum_counters[counter] += value;
+      }
+    }
+  }
+  if (stats -> is_profiling) {
+    fprintf(output, " \"phase_counters\": {");
+    for (uint32_t phase = 0; phase < STATS_PHASE_COUNT; ++phase) {
+      fprintf(output, "%s\n  \"%s\": ", phase ? "," : "",
+              STATS_PHASE_NAMES[phase]);
+      write_counters(stats, phase == STATS_SUMS ? sum_counters
+                            : stats -> phase_counters[phase]);
+    }
+    // La criba y la impresión son una sola fase cada una
+    fprintf(output, "\n },\n \"kernel_counters\": {\n  \"sieve\": ");
+    write_counters(stats, stats -> phase_counters[STATS_SIEVE]);
+    fprintf(output, ",\n  \"strong_sums\": ");
+    write_counters(stats, kernel_counters[STATS_STRONG_SUMS]);
+    fprintf(output, ",\n  \"weak_sums\": ");
+    write_counters(stats, kernel_counters[STATS_WEAK_SUMS]);
+    fprintf(output, ",\n  \"print\": ");
+    write_counters(stats, stats -> phase_counters[STATS_PRINT]);
+    fprintf(output, "\n },\n");
+  }
+  // Tiempo ocupado, ocioso y entradas de cada hilo de cálculo
+  fprintf(output, " \"thread_stats\": [");
+  for (uint32_t thread = 0; thread < stats -> thread_count; ++thread) {
+    const stats_thread_t* current = &stats -> threads[thread];
+    double idle_time = stats -> phase_times[STATS_SUMS] - current -> busy_time;
+    fprintf(output, "%s\n  {\"thread\": %" PRIu32 ", \"busy_seconds\": %.9f"
+            ", \"idle_seconds\": %.9f, \"entries\": %" PRIu64,
+            thread ? "," : "", thread, current -> busy_time,
+            idle_time > 0 ? idle_time : 0, current -> entry_count);
+    if (stats -> is_profiling) {
+      for (uint32_t counter = 0; counter < STATS_COUNTER_COUNT; ++counter) {
+        thread_counters[counter] = 0;
+        for (uint32_t kernel = 0; kernel < STATS_KERNEL_COUNT; ++kernel)
+          thread_counters[counter] += current -> counters[kernel][counter];
+      }
+      fprintf(output, ", \"counters\": ");
+      write_counters(stats, thread_counters);
+    }
+    fprintf(output, "}");
+  }
+  fprintf(output, "\n ]}\n");
+  fflush(output);
+}
+
+void write_counters(stats_t* stats, const uint64_t* counters) {
+  assert(stats);
+  fprintf(stats -> output, "{");
+  for (uint32_t counter = 0; counter < STATS_COUNTER_COUNT; ++counter) {
+    fprintf(stats -> output, "%s\"%s\": ", counter ? ", " : "",
+            STATS_COUNTER_NAMES[counter]);
+    if (stats -> has_counter[counter])
+      fprintf(stats -> output, "%" PRIu64, counters[counter]);
+    else
+      fprintf(stats -> output, "null");
+  }
+  fprintf(stats -> output, "}");
+}
+
+void stats_destroy(stats_t* stats) {
+  assert(stats);
+  // Liberar memoria empleada por la estructura
+  if (stats -> output != stderr)
+    fclose(stats -> output);
+  for (uint32_t index = 0; index < stats -> descriptor_count; ++index)
+    close(stats -> descriptors[index]);
+  pthread_mutex_destroy(&stats -> mutex);
+  free(stats -> descriptors);
+  free(stats -> threads);
+  free(stats);
+}
@@ -0,0 +1,247 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef STATS_H
+#define STATS_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/// Tamaño de una línea de caché, al que se alinea cada stats_thread_t
+#define STATS_CACHE_LINE_SIZE 64
+
+/// Fases del programa cuyo tiempo se mide por separado
+typedef enum stats_phase {
+  STATS_READ,
+  STATS_SIEVE,
+  STATS_TABLE,
+  STATS_SCHEDULE,
+  STATS_SUMS,
+  STATS_PRINT,
+  STATS_PHASE_COUNT
+} stats_phase_t;
+
+/// Contadores de perf_event_open que registra el modo de perfilado
+typedef enum stats_counter {
+  STATS_TASK_CLOCK,
+  STATS_CYCLES,
+  STATS_INSTRUCTIONS,
+  STATS_CACHE_MISSES,
+  STATS_BRANCH_MISSES,
+  STATS_COUNTER_COUNT
+} stats_counter_t;
+
+/// Núcleos de cálculo de un hilo, según el tipo de la entrada calculada
+typedef enum stats_kernel {
+  STATS_STRONG_SUMS,
+  STATS_WEAK_SUMS,
+  STATS_OTHER_ENTRIES,
+  STATS_KERNEL_COUNT
+} stats_kernel_t;
+
+/**
+ * @brief Instante de una medición, con los contadores del hilo que la tomó
+ * @details Los contadores solo se leen en el modo de perfilado
+ */
+typedef struct stats_mark {
+  double time;
+  uint64_t counters[STATS_COUNTER_COUNT];
+} stats_mark_t;
+
+/**
+ * @brief Mediciones de un hilo de cálculo
+ * @details Cada hilo escribe solo en su propia estructura, la cual se
+ *          alinea a una línea de caché y se redondea a un múltiplo de ella
+ *          para que los hilos no compartan líneas al actualizarlas
+ */
+typedef struct stats_thread {
+  double busy_time;
+  uint64_t entry_count;
+  uint64_t counters[STATS_KERNEL_COUNT][STATS_COUNTER_COUNT];
+} __attribute__((aligned(STATS_CACHE_LINE_SIZE))) stats_thread_t;
+
+_Static_assert(sizeof(stats_thread_t) % STATS_CACHE_LINE_SIZE == 0,
+               "stats_thread_t must fill whole cache lines");
+
+/**
+ * @brief Estructura de datos que acumula las mediciones de una corrida
+ * @details Guarda el tiempo de cada fase, el tiempo ocupado y las entradas
+ *          de cada hilo de cálculo y la cantidad de entradas de cada tipo,
+ *          y al final las escribe como JSON junto con la memoria máxima del
+ *          proceso. En el modo por lotes las fases son consecutivas y su
+ *          tiempo es de reloj; en el modo por flujo se solapan, por lo que
+ *          read, sieve y print acumulan el tiempo ocupado del lector y del
+ *          escritor y sums es lo que duran los hilos de cálculo. Las
+ *          tareas de taskloop que un hilo toma de la entrada de otro se
+ *          cuentan como tiempo ocupado del hilo dueño de la entrada.
+ *
+ *          En el modo de perfilado cada hilo abre además un grupo de
+ *          contadores de perf_event_open la primera vez que toma una
+ *          medición, y cada fase y cada entrada calculada acumulan la
+ *          diferencia de los contadores del hilo que las ejecutó, por lo
+ *          que la fase table, cuya convolución es paralela, solo cuenta al
+ *          hilo principal. Los contadores que el núcleo o la máquina
+ *          virtual no ofrecen se reportan como null.
+ */
+typedef struct stats {
+  FILE* output;
+  const char* mode;
+  bool is_profiling;
+  bool has_counter[STATS_COUNTER_COUNT];
+  struct timespec start_time;
+  double phase_times[STATS_PHASE_COUNT];
+  uint64_t phase_counters[STATS_PHASE_COUNT][STATS_COUNTER_COUNT];
+  uint32_t thread_count;
+  stats_thread_t* threads;
+  uint64_t strong_count;
+  uint64_t weak_count;
+  uint64_t invalid_count;
+  int* descriptors;
+  uint32_t descriptor_count;
+  pthread_mutex_t mutex;
+} stats_t;
+
+/**
+ * @brief Constructor, inicia la medición de la corrida
+ * @code
+ *   stats_t* stats = stats_create(stderr, 8, false);
+ * @endcode
+ * @param output archivo donde se escribe el JSON, stderr o uno abierto para
+ *        escribir que la estructura cierra al destruirse
+ * @param thread_count cantidad de hilos de cálculo
+ * @param is_profiling true para registrar también los contadores de
+ *        perf_event_open. Solo puede existir una estructura que perfile a
+ *        la vez, pues los grupos de contadores son propios de cada hilo.
+ * @return stats_t* estructura de datos
+ */
+stats_t* stats_create(FILE* output, uint32_t thread_count, bool is_profiling);
+
+/**
+ * @brief Toma el tiempo actual de CLOCK_MONOTONIC y, si se perfila, los
+ *        contadores del hilo que la invoca
+ * @details Si stats es NULL solo toma el tiempo
+ * @code
+ *   stats_mark_t start;
+ *   stats_mark(stats, &start);
+ * @endcode
+ * @param stats estructura de datos, o NULL
+ * @param mark medición a llenar
+ */
+void stats_mark(stats_t* stats, stats_mark_t* mark);
+
+/**
+ * @brief Suma a una fase el tiempo y los contadores transcurridos desde start
+ * @details Los contadores de la fase sums son la suma de los de los hilos de
+ *          cálculo, por lo que en ella solo se suma el tiempo
+ * @code
+ *   stats_add_phase(stats, STATS_READ, &start);
+ * @endcode
+ * @param stats estructura de datos
+ * @param phase fase medida
+ * @param start medición inicial tomada por el mismo hilo
+ */
+void stats_add_phase(stats_t* stats, stats_phase_t phase,
+                     const stats_mark_t* start);
+
+/**
+ * @brief Toma la medición inicial de una entrada y la registra como la que
+ *        mide el hilo actual hasta stats_add_busy
+ * @details Las tareas en que split_sums reparte la entrada consultan
+ *          stats_get_current para saber a qué estructura sumar su trabajo
+ * @code
+ *   stats_start_busy(stats, &start);
+ * @endcode
+ * @param stats estructura de datos
+ * @param start medición a llenar
+ */
+void stats_start_busy(stats_t* stats, stats_mark_t* start);
+
+/**
+ * @brief Retorna la estructura que mide la entrada en curso del hilo actual
+ * @code
+ *   stats_t* stats = stats_get_current();
+ * @endcode
+ * @return stats_t* estructura indicada a stats_start_busy, o NULL si el
+ *         hilo no está calculando una entrada medida
+ */
+stats_t* stats_get_current(void);
+
+/**
+ * @brief Suma a un hilo de cálculo una entrada y el tiempo y los contadores
+ *        transcurridos desde start, y termina la medición de la entrada
+ * @code
+ *   stats_add_busy(stats, omp_get_thread_num(), &start, value);
+ * @endcode
+ * @param stats estructura de datos
+ * @param thread número del hilo, los mayores que thread_count se ignoran
+ * @param start medición inicial tomada por el mismo hilo con
+ *        stats_start_busy
+ * @param value valor absoluto de la entrada, para elegir su núcleo
+ */
+void stats_add_busy(stats_t* stats, uint32_t thread,
+                    const stats_mark_t* start, uint64_t value);
+
+/**
+ * @brief Suma a un hilo de cálculo el tiempo y los contadores transcurridos
+ *        desde start sin contar una entrada
+ * @details Es la medición de una tarea de otra entrada que un hilo ejecuta
+ *          mientras no mide una propia, pues si no su entrada ya la incluye
+ * @code
+ *   stats_add_task(split -> stats, thread, &start, split -> number);
+ * @endcode
+ * @param stats estructura de datos
+ * @param thread número del hilo, los mayores que thread_count se ignoran
+ * @param start medición inicial tomada por el mismo hilo
+ * @param value valor absoluto de la entrada, para elegir su núcleo
+ */
+void stats_add_task(stats_t* stats, uint32_t thread,
+                    const stats_mark_t* start, uint64_t value);
+
+/**
+ * @brief Cuenta una entrada leída según su tipo
+ * @details Los pares mayores que cinco se cuentan como fuertes, los impares
+ *          mayores que cinco como débiles y el resto, que se imprime como
+ *          NA, como inválidos
+ * @code
+ *   stats_count_entry(stats, goldbach_get_value(goldbach));
+ * @endcode
+ * @param stats estructura de datos
+ * @param value valor absoluto de la entrada, o cero si es inválida
+ */
+void stats_count_entry(stats_t* stats, uint64_t value);
+
+/**
+ * @brief Escribe las mediciones como un objeto JSON
+ * @details El tiempo ocioso de cada hilo es el de la fase sums menos su
+ *          tiempo ocupado, y la memoria máxima se toma de getrusage. Al
+ *          perfilar se agregan los contadores de cada fase, de cada núcleo
+ *          (sieve, strong_sums, weak_sums y print) y de cada hilo.
+ * @code
+ *   stats_write(stats);
+ * @endcode
+ * @param stats estructura de datos
+ */
+void stats_write(stats_t* stats);
+
+/**
+ * @brief Destructor, cierra el archivo de salida si no es stderr y los
+ *        contadores abiertos
+ * @code
+ *   stats_destroy(stats);
+ * @endcode
+ * @param stats estructura de datos
+ */
+void stats_destroy(stats_t* stats);
+
+#endif  // !STATS_H
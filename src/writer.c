@@ -0,0 +1,72 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#include "writer.h"
+
+/// Representación decimal de cada número de 00 a 99
+static const char DIGIT_PAIRS[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536"
+  "37383940414243444546474849505152535455565758596061626364656667686970717273"
+  "7475767778798081828384858687888990919293949596979899";
+
+void writer_init(writer_t* writer, FILE* file) {
+  assert(writer);
+  // Inicializar campos de la estructura
+  writer -> file = file;
+  writer -> count = 0;
+  writer -> buffer = (char*) malloc(WRITER_CAPACITY);
+}
+
+void writer_destroy(writer_t* writer) {
+  assert(writer);
+  // Escribir lo pendiente y liberar la memoria utilizada por la estructura
+  writer_flush(writer);
+  free(writer -> buffer);
+}
+
+void writer_flush(writer_t* writer) {
+  assert(writer);
+  if (writer -> count) {
+    fwrite(writer -> buffer, 1, writer -> count, writer -> file);
+    writer -> count = 0;
+  }
+}
+
+void writer_put_string(writer_t* writer, const char* text, size_t length) {
+  assert(writer);
+  if (writer -> count + length > WRITER_CAPACITY) {
+    writer_flush(writer);
+    // Los textos más grandes que el búfer se escriben directamente
+    if (length > WRITER_CAPACITY) {
+      fwrite(text, 1, length, writer -> file);
+      return;
+    }
+  }
+  memcpy(writer -> buffer + writer -> count, text, length);
+  writer -> count += length;
+}
+
+void writer_put_uint64(writer_t* writer, uint64_t value) {
+  assert(writer);
+  if (writer -> count + WRITER_MAX_DIGITS > WRITER_CAPACITY)
+    writer_flush(writer);
+  char digits[WRITER_MAX_DIGITS];
+  char* start = digits + WRITER_MAX_DIGITS;
+  // Convertir de dos en dos dígitos, de derecha a izquierda
+  while (value >= 100) {
+    uint32_t pair = (uint32_t) (value % 100);
+    value /= 100;
+    start -= 2;
+    memcpy(start, DIGIT_PAIRS + 2 * pair, 2);
+  }
+  if (value >= 10) {
+    start -= 2;
+    memcpy(start, DIGIT_PAIRS + 2 * value, 2);
+  } else {
+    *--start = (char) ('0' + value);
+  }
+  size_t length = digits + WRITER_MAX_DIGITS - start;
+  memcpy(writer -> buffer + writer -> count, start, length);
+  writer -> count += length;
+}
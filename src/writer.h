@@ -0,0 +1,110 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+#ifndef WRITER_H
+#define WRITER_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+
+/// Capacidad del búfer de salida, se escribe al archivo al llenarse
+#define WRITER_CAPACITY (1u << 20)
+/// Mayor cantidad de dígitos decimales de un entero de 64 bits
+#define WRITER_MAX_DIGITS 20
+
+/**
+ * @brief Estructura de datos que acumula la salida en un búfer propio
+ * @details Evita el costo de printf por cada número: los enteros se
+ *          convierten a decimal de dos en dos dígitos con una tabla y todo
+ *          se copia a un búfer reutilizable, que se escribe al archivo con
+ *          un solo fwrite cuando se llena o se vacía explícitamente
+ */
+typedef struct writer {
+  FILE* file;
+  size_t count;
+  char* buffer;
+} writer_t;
+
+/**
+ * @brief Inicializador, reserva el búfer de WRITER_CAPACITY bytes
+ * @code
+ *   writer_init(&writer, stdout);
+ * @endcode
+ * @param writer estructura sin inicializar
+ * @param file archivo donde se escribe la salida
+ */
+void writer_init(writer_t* writer, FILE* file);
+
+/**
+ * @brief Destructor, escribe lo pendiente y libera el búfer
+ * @code
+ *   writer_destroy(&writer);
+ * @endcode
+ * @param writer estructura inicializada
+ */
+void writer_destroy(writer_t* writer);
+
+/**
+ * @brief Escribe al archivo el contenido del búfer con un solo fwrite
+ * @code
+ *   writer_flush(&writer);
+ * @endcode
+ * @param writer estructura inicializada
+ */
+void writer_flush(writer_t* writer);
+
+/**
+ * @brief Agrega length caracteres de text a la salida
+ * @code
+ *   writer_put_string(&writer, "sums", 4);
+ * @endcode
+ * @param writer estructura inicializada
+ * @param text caracteres a agregar
+ * @param length cantidad de caracteres
+ */
+void writer_put_string(writer_t* writer, const char* text, size_t length);
+
+/**
+ * @brief Agrega la representación decimal de value a la salida
+ * @code
+ *   writer_put_uint64(&writer, 1753664);
+ * @endcode
+ * @param writer estructura inicializada
+ * @param value número a agregar
+ */
+void writer_put_uint64(writer_t* writer, uint64_t value);
+
+/**
+ * @brief Agrega una cadena terminada en nulo a la salida
+ * @details Se define en el encabezado para que la longitud de las cadenas
+ *          literales se calcule al compilar
+ * @code
+ *   writer_put_text(&writer, " sums");
+ * @endcode
+ * @param writer estructura inicializada
+ * @param text cadena a agregar
+ */
+static inline void writer_put_text(writer_t* writer, const char* text) {
+  writer_put_string(writer, text, strlen(text));
+}
+
+/**
+ * @brief Agrega un caracter a la salida
+ * @code
+ *   writer_put_char(&writer, '\n');
+ * @endcode
+ * @param writer estructura inicializada
+ * @param character caracter a agregar
+ */
+static inline void writer_put_char(writer_t* writer, char character) {
+  if (writer -> count == WRITER_CAPACITY)
+    writer_flush(writer);
+  writer -> buffer[writer -> count++] = character;
+}
+
+#endif  // !WRITER_H
@@ -0,0 +1,163 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+// Programa de prueba de libgoldbach: usa la biblioteca solo mediante
+// engine.h, como cualquier otro programa. Varios hilos consultan a la vez un
+// mismo engine recién creado, de forma que compiten por crear las mismas
+// cribas y calcular los mismos valores, y luego se destruye con
+// engine_destroy. Se enlaza con la versión estática y con la compartida.
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "engine.h"
+
+/// Cantidad de hilos que consultan el mismo engine a la vez
+#define ENGINE_TEST_THREADS 8
+/// Cantidad de veces que se crea, consulta y destruye un engine
+#define ENGINE_TEST_ROUNDS 3
+
+/// Valor de prueba y su cantidad de sumas según el programa
+typedef struct engine_test_case {
+  uint64_t value;
+  uint64_t count;
+} engine_test_case_t;
+
+/// Datos que recibe cada hilo de prueba
+typedef struct engine_test_thread {
+  engine_t* engine;
+  uint32_t index;
+  bool is_failed;
+} engine_test_thread_t;
+
+/// Casos que cubren varias posiciones de criba, pares, impares y no válidos
+static const engine_test_case_t engine_test_cases[] = {
+  {21, 5}, {100, 6}, {77, 28}, {1000000, 5402}, {1000001, 104528645},
+  {2000000, 9720}, {100000000, 291400}, {5, 0}, {4, 0}
+};
+
+/// Cantidad de casos de prueba
+#define ENGINE_TEST_CASE_COUNT \
+  (sizeof(engine_test_cases) / sizeof(engine_test_cases[0]))
+
+/**
+ * @brief Función con el nombre de una auxiliar del caché de resultados
+ * @details Si la biblioteca exportara sus funciones auxiliares el enlace
+ *          fallaría por un símbolo duplicado
+ * @param value valor cualquiera
+ * @return uint64_t value
+ */
+uint64_t find_entry(uint64_t value);
+
+/**
+ * @brief Función con el nombre de una auxiliar de la criba
+ * @param value valor cualquiera
+ * @return uint64_t value
+ */
+uint64_t integer_root(uint64_t value);
+
+/**
+ * @brief Consulta todos los casos con engine_count, empezando por uno
+ *        distinto en cada hilo, y los pares con engine_count_batch
+ * @param data estructura engine_test_thread_t
+ * @return void* NULL
+ */
+void* engine_test_query(void* data);
+
+/**
+ * @brief Comprueba que cada suma de value enumerada sume value
+ * @param data valor enumerado y si alguna suma fue incorrecta
+ * @param addends sumandos de la suma
+ * @param count cantidad de sumandos
+ */
+void engine_test_visit(void* data, const uint64_t* addends, uint32_t count);
+
+/**
+ * @brief Crea un engine, lo consulta desde varios hilos y lo destruye
+ * @return true si todas las consultas retornaron lo esperado
+ */
+bool engine_test_round(void);
+
+int main(void) {
+  bool is_failed = false;
+  for (uint32_t round = 0; round < ENGINE_TEST_ROUNDS; ++round)
+    is_failed |= !engine_test_round();
+  printf("engine_test: %s\n", is_failed ? "FAILED" : "OK");
+  return is_failed;
+}
+
+uint64_t find_entry(uint64_t value) {
+  return value;
+}
+
+uint64_t integer_root(uint64_t value) {
+  return value;
+}
+
+bool engine_test_round(void) {
+  engine_t* engine = engine_create(2);
+  pthread_t threads[ENGINE_TEST_THREADS];
+  engine_test_thread_t data[ENGINE_TEST_THREADS];
+  for (uint32_t index = 0; index < ENGINE_TEST_THREADS; ++index) {
+    data[index] = (engine_test_thread_t) {engine, index, false};
+    pthread_create(&threads[index], NULL, engine_test_query, &data[index]);
+  }
+  bool is_failed = false;
+  for (uint32_t index = 0; index < ENGINE_TEST_THREADS; ++index) {
+    pthread_join(threads[index], NULL);
+    is_failed |= data[index].is_failed;
+  }
+  // Enumerar con las cribas que ya crearon los hilos
+  uint64_t visited[2] = {1000000, 0};
+  uint64_t count = engine_enumerate(engine, 1000000, engine_test_visit,
+                                    visited);
+  if (count != 5402 || visited[1]) {
+    fprintf(stderr, "error: engine_enumerate(1000000) = %" PRIu64 "\n",
+            count);
+    is_failed = true;
+  }
+  engine_destroy(engine);
+  return !is_failed;
+}
+
+void* engine_test_query(void* data) {
+  engine_test_thread_t* thread = (engine_test_thread_t*) data;
+  for (uint32_t offset = 0; offset < ENGINE_TEST_CASE_COUNT; ++offset) {
+    const engine_test_case_t* test_case = &engine_test_cases[
+        (thread -> index + offset) % ENGINE_TEST_CASE_COUNT];
+    uint64_t count = engine_count(thread -> engine, test_case -> value);
+    if (count != test_case -> count) {
+      fprintf(stderr, "error: engine_count(%" PRIu64 ") = %" PRIu64 "\n",
+              test_case -> value, count);
+      thread -> is_failed = true;
+    }
+  }
+  if (thread -> index % 2 == 0) {
+    uint64_t values[ENGINE_TEST_CASE_COUNT];
+    uint64_t counts[ENGINE_TEST_CASE_COUNT];
+    for (uint32_t index = 0; index < ENGINE_TEST_CASE_COUNT; ++index)
+      values[index] = engine_test_cases[index].value;
+    engine_count_batch(thread -> engine, values, ENGINE_TEST_CASE_COUNT,
+                       counts);
+    for (uint32_t index = 0; index < ENGINE_TEST_CASE_COUNT; ++index) {
+      if (counts[index] != engine_test_cases[index].count) {
+        fprintf(stderr, "error: engine_count_batch(%" PRIu64 ") = %" PRIu64
+                "\n", values[index], counts[index]);
+        thread -> is_failed = true;
+      }
+    }
+  }
+  return NULL;
+}
+
+void engine_test_visit(void* data, const uint64_t* addends, uint32_t count) {
+  uint64_t* visited = (uint64_t*) data;
+  uint64_t sum = 0;
+  for (uint32_t index = 0; index < count; ++index)
+    sum += addends[index];
+  if (sum != visited[0])
+    visited[1] = 1;
+}
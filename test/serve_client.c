@@ -0,0 +1,147 @@
+/// @copyright 2022 ECCI, Universidad de Costa Rica. All rights reserved
+/// @author Esteban Castañeda Blanco <esteban.castaneda@ucr.ac.cr>
+/// This code is released under the GNU Public License version 3
+
+// Cliente de prueba del servidor: envía la entrada estándar al socket de
+// dominio Unix que recibe como argumento y escribe la respuesta en la salida
+// estándar. Lee y escribe a la vez con poll, pues el servidor responde
+// mientras el cliente aún envía valores y ambos búferes del socket podrían
+// llenarse si se enviara todo antes de leer.
+
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/// Tamaño de los bloques que se leen y escriben
+#define SERVE_CLIENT_BUFFER_SIZE 4096
+
+/**
+ * @brief Conecta un socket al servidor que escucha en path
+ * @param path ruta del socket de dominio Unix
+ * @return int descriptor del socket, o -1 si no se pudo conectar
+ */
+int serve_client_connect(const char* path);
+
+/**
+ * @brief Escribe todo el bloque en el descriptor, aunque lo acepte por partes
+ * @param descriptor descriptor de destino
+ * @param buffer bloque a escribir
+ * @param size cantidad de bytes del bloque
+ * @return int 0 si se escribió completo, o -1 si hubo un error
+ */
+int serve_client_write(int descriptor, const char* buffer, size_t size);
+
+/**
+ * @brief Envía la entrada estándar y copia la respuesta a la salida estándar
+ * @details Cierra la dirección de escritura del socket al terminar la
+ *          entrada, de modo que el servidor responde lo pendiente y cierra
+ *          la conexión
+ * @param socket_descriptor socket conectado al servidor
+ * @return int 0 si se recibió la respuesta completa, o 1 si hubo un error
+ */
+int serve_client_run(int socket_descriptor);
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s SOCKET < input\n", argv[0]);
+    return 1;
+  }
+  int socket_descriptor = serve_client_connect(argv[1]);
+  if (socket_descriptor == -1) {
+    fprintf(stderr, "error: could not connect to %s: %s\n", argv[1],
+            strerror(errno));
+    return 1;
+  }
+  int error = serve_client_run(socket_descriptor);
+  close(socket_descriptor);
+  return error;
+}
+
+int serve_client_connect(const char* path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  strcpy(address.sun_path, path);
+  int socket_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (socket_descriptor != -1 && connect(socket_descriptor,
+      (struct sockaddr*) &address, sizeof(address)) == -1) {
+    close(socket_descriptor);
+    socket_descriptor = -1;
+  }
+  return socket_descriptor;
+}
+
+int serve_client_write(int descriptor, const char* buffer, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(descriptor, buffer, size);
+    if (written == -1) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    buffer += written;
+    size -= (size_t) written;
+  }
+  return 0;
+}
+
+int serve_client_run(int socket_descriptor) {
+  char input[SERVE_CLIENT_BUFFER_SIZE];
+  char output[SERVE_CLIENT_BUFFER_SIZE];
+  size_t pending = 0;
+  size_t offset = 0;
+  struct pollfd descriptors[2] = {
+    {.fd = socket_descriptor, .events = POLLIN},
+    {.fd = STDIN_FILENO, .events = POLLIN}
+  };
+  // La entrada solo se lee cuando ya se envió el bloque anterior, y se deja
+  // de vigilar al terminar
+  bool is_input_open = true;
+  while (1) {
+    descriptors[0].events = pending > 0 ? POLLIN | POLLOUT : POLLIN;
+    nfds_t count = is_input_open && pending == 0 ? 2 : 1;
+    if (poll(descriptors, count, -1) == -1) {
+      if (errno == EINTR)
+        continue;
+      return 1;
+    }
+    if (count == 2 && descriptors[1].revents) {
+      ssize_t size = read(STDIN_FILENO, input, sizeof(input));
+      if (size < 0)
+        return 1;
+      if (size == 0) {
+        shutdown(socket_descriptor, SHUT_WR);
+        is_input_open = false;
+      }
+      pending = (size_t) size;
+      offset = 0;
+    }
+    if (pending > 0 && (descriptors[0].revents & POLLOUT)) {
+      // Enviar sin bloquear solo lo que cabe en el socket
+      ssize_t sent = send(socket_descriptor, input + offset, pending,
+                          MSG_DONTWAIT | MSG_NOSIGNAL);
+      if (sent == -1 && errno != EAGAIN && errno != EINTR)
+        return 1;
+      if (sent > 0) {
+        offset += (size_t) sent;
+        pending -= (size_t) sent;
+      }
+    }
+    if (descriptors[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      ssize_t size = read(socket_descriptor, output, sizeof(output));
+      if (size <= 0)
+        return size < 0 || is_input_open || pending > 0;
+      if (serve_client_write(STDOUT_FILENO, output, (size_t) size) == -1)
+        return 1;
+    }
+  }
+}